@@ -2,6 +2,8 @@
 #include "ve_camera.h"
 #include "systems/simple_render_system.h"
 #include "systems/point_light_system.h"
+#include "systems/transform_system.h"
+#include "ve_system_scheduler.h"
 
 #include "keyboard_movement_controller.h"
 #include "ve_buffer.h"
@@ -28,17 +30,6 @@ namespace ve
 			.addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VeSwapChain::MAX_FRAMES_IN_FLIGHT)
 			.build();
 
-		framePools.resize(VeSwapChain::MAX_FRAMES_IN_FLIGHT);
-
-		auto framePoolBuilder = VeDescriptorPool::Builder(veDevice)
-			.setMaxSets(1000)
-			.addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1000)
-			.addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1000)
-			.setPoolFlags(VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
-
-		for (int i = 0; i < framePools.size(); i++)
-			framePools[i] = framePoolBuilder.build();
-
 		loadEntities();
 	}
 
@@ -80,8 +71,38 @@ namespace ve
 		std::cout << "Alignment: " << veDevice.properties.limits.minUniformBufferOffsetAlignment << "\n";
 		std::cout << "atom size: " << veDevice.properties.limits.nonCoherentAtomSize << "\n";
 
-		SimpleRenderSystem simpleRenderSystem{ veDevice, veRenderer.getSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout() };
+		SimpleRenderSystem simpleRenderSystem{ veDevice, veRenderer.getSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout(), objectManager, textureTable, meshBuffer };
 		PointLightSystem pointLightSystem{ veDevice, veRenderer.getSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout() };
+		TransformSystem transformSystem{};
+
+		// systems that update the world before rendering, the scheduler runs the ones that don't
+		// touch the same components at the same time
+		GlobalUbo ubo{};
+		VeSystemScheduler scheduler{ jobSystem };
+		scheduler.addSystem("LightOrbit", SystemAccess().write<TransformComponent>().read<PointLightComponent>(),
+			[this](FrameInfo& frameInfo)
+			{
+				// one angle axis per frame, rotating each light is then only multiply-adds
+				const glm::quat rotateLight = glm::angleAxis(frameInfo.frameTime, glm::vec3{ 0.f, -1.f, 0.f });
+				jobSystem.parallelForEach(frameInfo.entityManager.view<TransformComponent, const PointLightComponent>(), 64,
+					[&rotateLight](entity_t entity, TransformComponent& transComp, const PointLightComponent& pointLight)
+					{
+						transComp.translation = rotateLight * transComp.translation;
+					});
+			});
+		// the transform system takes the change bits of what it reads, the object buffer update those of the world transforms
+		scheduler.addSystem("TransformPropagation", SystemAccess()
+			.read<TransformComponent, HierarchyComponent, MobilityComponent>()
+			.consume<TransformComponent, HierarchyComponent, MobilityComponent>()
+			.write<WorldTransformComponent>(),
+			[&transformSystem](FrameInfo& frameInfo) { transformSystem.update(frameInfo.entityManager); },
+			{ "LightOrbit" });
+		scheduler.addSystem("PointLightUpdate", SystemAccess().read<WorldTransformComponent, PointLightComponent>(),
+			[&pointLightSystem, &ubo](FrameInfo& frameInfo) { pointLightSystem.update(frameInfo, ubo); },
+			{ "TransformPropagation" });
+		scheduler.addSystem("ObjectBufferUpdate", SystemAccess().read<WorldTransformComponent, MobilityComponent>().consume<WorldTransformComponent>(),
+			[this](FrameInfo& frameInfo) { objectManager.updateBuffer(frameInfo.frameIndex); },
+			{ "TransformPropagation" });
 
 		VeCamera camera{};
 
@@ -111,36 +132,32 @@ namespace ve
             {
 				int frameIndex = veRenderer.getFrameIndex();
 
-				framePools[frameIndex]->resetPool();
-
 				FrameInfo frameInfo{
 					frameIndex,
 					frameTime,
 					commandBuffer,
 					camera,
 					globalDescriptorSets[frameIndex],
-					*framePools[frameIndex],
 					objectManager
 				};
 
 				// update
-				glm::mat4 rotateLight = glm::rotate(glm::mat4(1.0f), frameInfo.frameTime, { 0.f, -1.f, 0.f });
-				for (entity_t entity : frameInfo.entityManager.getEntities<PointLightComponent>())
-				{
-					TransformComponent& transComp = frameInfo.entityManager.GetComponent<TransformComponent>(entity);
-					transComp.translation = glm::vec3(rotateLight * glm::vec4(transComp.translation, 1.0f));
-				}
-
-
-				GlobalUbo ubo{};
+				ubo = GlobalUbo{};
 				ubo.projection = camera.getProjection();
 				ubo.view = camera.getView();
 				ubo.inverseView = camera.getInverseView();
-				pointLightSystem.update(frameInfo, ubo);
+				// structural changes since the last frame reach the observers before any system runs
+				objectManager.flushObservers();
+				// the systems only write into the object buffer, growing it replaces the buffer
+				objectManager.reserveObjectBuffer(frameIndex);
+				scheduler.run(frameInfo);
+				// bakes with the world transforms the systems just wrote, the upload can't be recorded inside the render pass
+				objectManager.updateStaticBuffer(commandBuffer, frameIndex);
 				uboBuffers[frameIndex]->writeToBuffer(&ubo);
 				uboBuffers[frameIndex]->flush();
 
-				objectManager.updateBuffer(frameIndex);
+				// compute work can't be recorded inside the render pass
+				simpleRenderSystem.cullGameObjects(frameInfo);
 
                 // begin offscreen shadow pass
                 // render shadow casting objects
@@ -172,6 +189,15 @@ namespace ve
 		std::shared_ptr<VeTexture> icing = std::make_shared<VeTexture>(veDevice, "content/icing.png");
 		std::shared_ptr<VeTexture> nada = std::make_shared<VeTexture>(veDevice, "content/nada.jpg");
 
+		// registered so scene snapshots can refer to them by id
+		objectManager.registerModel("content/flat_vase.obj", flat_vase);
+		objectManager.registerModel("content/smooth_vase.obj", smooth_vase);
+		objectManager.registerModel("content/quad.obj", quad);
+		objectManager.registerModel("content/donut.obj", donut);
+		objectManager.registerTexture("content/texture.jpg", tex);
+		objectManager.registerTexture("content/icing.png", icing);
+		objectManager.registerTexture("content/nada.jpg", nada);
+
 		entity_t entity = objectManager.createMeshObject(flat_vase);
 		objectManager.GetComponent<TransformComponent>(entity).translation = { -.5f, .5f, 0.f };
 		objectManager.GetComponent<TransformComponent>(entity).scale = glm::vec3{ 3.f, 1.5f, 3.f };
@@ -188,6 +214,10 @@ namespace ve
 		objectManager.GetComponent<TransformComponent>(entity).translation = { 0.f, .5f, 2.0f };
 		objectManager.GetComponent<TransformComponent>(entity).scale = glm::vec3{ .5f };
 
+		// the scene itself never moves, only the lights orbit
+		for (entity_t mesh : objectManager.getEntities<RendererComponent>())
+			objectManager.setMobility(mesh, Mobility::Static);
+
 
 
 		std::vector<glm::vec3> lightColors{
@@ -4,7 +4,10 @@
 #include "ve_window.h"
 #include "ve_device.h"
 #include "ve_renderer.h"
+#include "ve_job_system.h"
 #include "ve_object_manager.h"
+#include "ve_texture_table.h"
+#include "ve_mesh_buffer.h"
 
 // std
 #include <memory>
@@ -33,9 +36,13 @@ namespace ve
 
 
         std::unique_ptr<VeDescriptorPool> globalPool;
-        std::vector<std::unique_ptr<VeDescriptorPool>> framePools;
 
-        VeObjectManager objectManager{ veDevice };
+        // textures register into the table when they are created, so it has to outlive the objects
+        VeTextureTable textureTable{ veDevice };
+        // same for models and the mesh buffer
+        VeMeshBuffer meshBuffer{ veDevice };
+        VeJobSystem jobSystem;
+        VeObjectManager objectManager{ veDevice, jobSystem };
 
     };
 }
\ No newline at end of file
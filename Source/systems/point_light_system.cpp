@@ -69,29 +69,26 @@ namespace ve
 
 	void PointLightSystem::update(FrameInfo& frameInfo, GlobalUbo& ubo)
 	{
-		std::map<float, entity_t, std::greater<float>> sortedIds;
-		for (entity_t entity : frameInfo.entityManager.getEntities<PointLightComponent>())
+		std::map<float, PointLight, std::greater<float>> sortedLights;
+		for (auto [entity, worldTransform, pointLight] : frameInfo.entityManager.view<const WorldTransformComponent, const PointLightComponent>())
 		{
-			const TransformComponent& transComp = frameInfo.entityManager.GetComponent<TransformComponent>(entity);
-
+			// lights can be attached to other objects, so their position comes from the world matrix
+			const glm::vec3 position{ worldTransform.matrix[3] };
 			// calculate distance
-			glm::vec3 offset = frameInfo.camera.getPosition() - transComp.translation;
+			glm::vec3 offset = frameInfo.camera.getPosition() - position;
 			float disSquared = glm::dot(offset, offset);
-			sortedIds[disSquared] = entity;
+			sortedLights[disSquared] = {
+				glm::vec4(position, 1.0f),
+				glm::vec4(pointLight.color, pointLight.lightIntensity) };
 		}
 
 		int lightIndex = 0;
-		for (auto& kv : sortedIds)
+		for (auto& kv : sortedLights)
 		{
 			assert(lightIndex < MAX_LIGHTS && "Point lights exceed maximum specified");
 
-			entity_t entity = kv.second;
-			const TransformComponent& transComp = frameInfo.entityManager.GetComponent<TransformComponent>(entity);
-			const PointLightComponent& pointLight = frameInfo.entityManager.GetComponent<PointLightComponent>(entity);
-
 			// copy light to ubo 
-			ubo.pointLights[lightIndex].position = glm::vec4(transComp.translation, 1.0f);
-			ubo.pointLights[lightIndex].color = glm::vec4(pointLight.color, pointLight.lightIntensity);
+			ubo.pointLights[lightIndex] = kv.second;
 			lightIndex++;
 		}
 		ubo.numLights = lightIndex;
@@ -109,7 +106,7 @@ namespace ve
 			pipelineLayout,
 			0, 1, &frameInfo.globalDescriptorSet, 0, nullptr);
 
-		int numOfLightComps = frameInfo.entityManager.getPool<PointLightComponent>().size();
+		int numOfLightComps = static_cast<int>(frameInfo.entityManager.getEntities<PointLightComponent>().size());
 
 		vkCmdDraw(frameInfo.commandBuffer, 6 , numOfLightComps, 0, 0);
 	}
@@ -4,48 +4,448 @@
 #include <glm/gtc/constants.hpp>
 
 // std
+#include <cassert>
 #include <stdexcept>
 #include <array>
 
 namespace ve
 {
-	struct  SimplePushConstantData
+	// planes of the view frustum from the rows of projection * view, normals point inwards.
+	// depth goes from zero to one, so the near plane is the third row alone
+	static void computeFrustumPlanes(const glm::mat4& projectionView, glm::vec4 outPlanes[6])
 	{
-		glm::mat4 modelMatrix{ 1.0f };
-		glm::mat4 normalMatrix{ 1.0f };
-	};
+		const glm::mat4 rows = glm::transpose(projectionView);
+		outPlanes[0] = rows[3] + rows[0];
+		outPlanes[1] = rows[3] - rows[0];
+		outPlanes[2] = rows[3] + rows[1];
+		outPlanes[3] = rows[3] - rows[1];
+		outPlanes[4] = rows[2];
+		outPlanes[5] = rows[3] - rows[2];
+		for (int i = 0; i < 6; i++)
+			outPlanes[i] /= glm::length(glm::vec3(outPlanes[i]));
+	}
 
-	SimpleRenderSystem::SimpleRenderSystem(VeDevice& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout) : veDevice(device)
+	SimpleRenderSystem::SimpleRenderSystem(VeDevice& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout, VeObjectManager& inObjectManager, VeTextureTable& inTextureTable, VeMeshBuffer& inMeshBuffer)
+		: veDevice(device), objectManager(inObjectManager), textureTable(inTextureTable), meshBuffer(inMeshBuffer)
 	{
 		createPipelineLayout(globalSetLayout);
 		createPipeline(renderPass);
+		createCullPipeline();
+		createFrameResources();
+
+		// renderers that already exist were never reported to these observers
+		const std::vector<entity_t> renderers = objectManager.getEntities<RendererComponent>();
+		addRenderers(renderers.data(), static_cast<int32_t>(renderers.size()));
+
+		auto writeRenderers = [this](const entity_t* entities, int32_t count) { addRenderers(entities, count); };
+		observers[0] = objectManager.observe<RendererComponent>(COMPONENT_ADDED, writeRenderers);
+		observers[1] = objectManager.observe<RendererComponent>(COMPONENT_REMOVED,
+			[this](const entity_t* entities, int32_t count) { removeRenderers(entities, count); });
+		// a renderer that was written to may use another model or texture now, its entry is written again
+		observers[2] = objectManager.observe<RendererComponent>(COMPONENT_UPDATED, writeRenderers);
 	}
 
 	SimpleRenderSystem::~SimpleRenderSystem()
 	{
+		for (ObserverID observer : observers)
+			objectManager.removeObserver<RendererComponent>(observer);
+		vkDestroyPipelineLayout(veDevice.device(), cullPipelineLayout, nullptr);
 		vkDestroyPipelineLayout(veDevice.device(), pipelineLayout, nullptr);
 	}
 
-	void SimpleRenderSystem::createPipelineLayout(VkDescriptorSetLayout globalSetLayout)
+	void SimpleRenderSystem::createCullPipeline()
 	{
+		cullSetLayout = VeDescriptorSetLayout::Builder(veDevice)
+			.addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.build();
+
 		VkPushConstantRange pushConstantRange{};
-		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-		pushConstantRange.offset = 0; // offset field is mainly for if you are using seperate ranges for vertex and fragment shader.
-		pushConstantRange.size = sizeof(SimplePushConstantData);
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(CullPushConstants);
+
+		VkDescriptorSetLayout setLayout = cullSetLayout->getDescriptorSetLayout();
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &setLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+		if (vkCreatePipelineLayout(veDevice.device(), &pipelineLayoutInfo, nullptr, &cullPipelineLayout) != VK_SUCCESS)
+			throw std::runtime_error("failed to create pipeline layout!");
+
+		cullPipeline = std::make_unique<VeComputePipeline>(veDevice, cullPipelineLayout, "compiled_shaders/cull.comp.spv");
+		compactPipeline = std::make_unique<VeComputePipeline>(veDevice, cullPipelineLayout, "compiled_shaders/cull_compact.comp.spv");
+	}
+
+	void SimpleRenderSystem::createFrameResources()
+	{
+		framePool = VeDescriptorPool::Builder(veDevice)
+			.setMaxSets(VeSwapChain::MAX_FRAMES_IN_FLIGHT * 2)
+			.addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VeSwapChain::MAX_FRAMES_IN_FLIGHT * 10)
+			.build();
+		for (FrameResources& frame : frames)
+		{
+			if (!framePool->allocateDescriptor(objectSetLayout->getDescriptorSetLayout(), frame.objectSet)
+				|| !framePool->allocateDescriptor(cullSetLayout->getDescriptorSetLayout(), frame.cullSet))
+				throw std::runtime_error("failed to allocate object descriptor set!");
+			reserveBuffer(frame.cullEntries, sizeof(CullEntry), INITIAL_INSTANCE_CAPACITY,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			reserveBuffer(frame.drawInfos, sizeof(DrawInfo), INITIAL_DRAW_CAPACITY,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			reserveBuffer(frame.drawCounters, sizeof(uint32_t), INITIAL_DRAW_CAPACITY + 1,
+				DRAW_COUNTER_USAGE, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			reserveBuffer(frame.drawCommands, sizeof(VkDrawIndexedIndirectCommand), INITIAL_DRAW_CAPACITY,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			reserveBuffer(frame.instances, sizeof(InstanceData), INITIAL_INSTANCE_CAPACITY,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		}
+	}
+
+	bool SimpleRenderSystem::reserveBuffer(std::unique_ptr<VeBuffer>& buffer, VkDeviceSize instanceSize, uint32_t count,
+		VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags memoryPropertyFlags)
+	{
+		if (buffer && buffer->getInstanceCount() >= count)
+			return false;
+
+		uint32_t capacity = buffer ? buffer->getInstanceCount() : count;
+		while (capacity < count)
+			capacity *= 2;
+		buffer = std::make_unique<VeBuffer>(veDevice, instanceSize, capacity, usageFlags, memoryPropertyFlags);
+		if (memoryPropertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+			buffer->map();
+		return true;
+	}
+
+	void SimpleRenderSystem::writeFrameSets(int frameIndex)
+	{
+		FrameResources& frame = frames[frameIndex];
+		VkDescriptorBufferInfo frameInfo = objectManager.getObjectBufferInfo(frameIndex);
+		// while nothing is baked no instance references the static buffer, the binding
+		// still has to point at a valid buffer
+		VkDescriptorBufferInfo staticInfo = objectManager.getStaticObjectBufferInfo();
+		if (staticInfo.buffer == VK_NULL_HANDLE)
+			staticInfo = frameInfo;
+		VkDescriptorBufferInfo cullEntryInfo = frame.cullEntries->descriptorInfo();
+		VkDescriptorBufferInfo drawInfoInfo = frame.drawInfos->descriptorInfo();
+		VkDescriptorBufferInfo drawCounterInfo = frame.drawCounters->descriptorInfo();
+		VkDescriptorBufferInfo instanceInfo = frame.instances->descriptorInfo();
+		VkDescriptorBufferInfo drawCommandInfo = frame.drawCommands->descriptorInfo();
+
+		VeDescriptorWriter(*objectSetLayout, *framePool)
+			.writeBuffer(0, &frameInfo)
+			.writeBuffer(1, &staticInfo)
+			.writeBuffer(2, &instanceInfo)
+			.overwrite(frame.objectSet);
+		VeDescriptorWriter(*cullSetLayout, *framePool)
+			.writeBuffer(0, &frameInfo)
+			.writeBuffer(1, &staticInfo)
+			.writeBuffer(2, &cullEntryInfo)
+			.writeBuffer(3, &drawInfoInfo)
+			.writeBuffer(4, &drawCounterInfo)
+			.writeBuffer(5, &instanceInfo)
+			.writeBuffer(6, &drawCommandInfo)
+			.overwrite(frame.cullSet);
+	}
+
+	void SimpleRenderSystem::addRenderers(const entity_t* entities, int32_t count)
+	{
+		for (int32_t i = 0; i < count; i++)
+		{
+			const entity_t entity = entities[i];
+			if (static_cast<size_t>(entity) >= entrySlots.size())
+				entrySlots.resize(static_cast<size_t>(entity) + 1, INVALID_SLOT);
+
+			uint32_t slot = entrySlots[entity];
+			if (slot == INVALID_SLOT)
+			{
+				slot = static_cast<uint32_t>(cullEntries.size());
+				entrySlots[entity] = slot;
+				cullEntries.push_back({ glm::vec4{ 0.f }, 0, 0, INVALID_SLOT, 0 });
+				entryEntities.push_back(entity);
+			}
+			writeCullEntry(entity, slot);
+		}
+	}
+
+	void SimpleRenderSystem::removeRenderers(const entity_t* entities, int32_t count)
+	{
+		for (int32_t i = 0; i < count; i++)
+		{
+			// removals are reported for renderers added since the last flush as well
+			const entity_t entity = entities[i];
+			if (static_cast<size_t>(entity) >= entrySlots.size() || entrySlots[entity] == INVALID_SLOT)
+				continue;
+
+			const uint32_t slot = entrySlots[entity];
+			const uint32_t last = static_cast<uint32_t>(cullEntries.size()) - 1;
+			releaseDrawGroup(cullEntries[slot].draw);
+			if (slot != last)
+			{
+				cullEntries[slot] = cullEntries[last];
+				entryEntities[slot] = entryEntities[last];
+				entrySlots[entryEntities[slot]] = slot;
+				markEntryDirty(slot);
+			}
+			cullEntries.pop_back();
+			entryEntities.pop_back();
+			entrySlots[entity] = INVALID_SLOT;
+		}
+	}
+
+	void SimpleRenderSystem::writeCullEntry(entity_t entity, uint32_t slot)
+	{
+		const RendererComponent& renderComp = objectManager.ReadComponent<RendererComponent>(entity);
+		// renderers without a texture in the table sample the default one
+		uint32_t textureIndex = renderComp.diffuseMap ? renderComp.diffuseMap->getTextureIndex() : VeTextureTable::INVALID_INDEX;
+		if (textureIndex == VeTextureTable::INVALID_INDEX)
+			textureIndex = VeTextureTable::DEFAULT_INDEX;
+
+		CullEntry& entry = cullEntries[slot];
+		const uint32_t draw = findDrawGroup(renderComp.model);
+		if (entry.draw != draw)
+		{
+			if (entry.draw != INVALID_SLOT)
+				releaseDrawGroup(entry.draw);
+			drawGroups[draw].rendererCount++;
+			drawGroupsChanged = true;
+		}
+		entry.boundingSphere = renderComp.model->getBoundingSphere();
+		entry.object = objectManager.getObjectReference(entity);
+		entry.texture = textureIndex;
+		entry.draw = draw;
+		markEntryDirty(slot);
+	}
+
+	void SimpleRenderSystem::markEntryDirty(uint32_t slot)
+	{
+		for (uint32_t i = 0; i < VeSwapChain::MAX_FRAMES_IN_FLIGHT; i++)
+		{
+			if (staleFrames & (1u << i))
+				continue;
+
+			// past that many slots writing all of them is cheaper than tracking them
+			std::vector<uint32_t>& dirtyEntries = frames[i].dirtyEntries;
+			if (dirtyEntries.size() >= cullEntries.size() / 2)
+			{
+				staleFrames |= 1u << i;
+				dirtyEntries.clear();
+			}
+			else
+				dirtyEntries.push_back(slot);
+		}
+	}
+
+	uint32_t SimpleRenderSystem::findDrawGroup(const std::shared_ptr<VeModel>& model)
+	{
+		auto found = drawGroupIndices.find(model.get());
+		if (found != drawGroupIndices.end())
+			return found->second;
+
+		uint32_t draw;
+		if (!freeDrawGroups.empty())
+		{
+			draw = freeDrawGroups.back();
+			freeDrawGroups.pop_back();
+		}
+		else
+		{
+			draw = static_cast<uint32_t>(drawGroups.size());
+			drawGroups.emplace_back();
+		}
+		drawGroups[draw] = { model, 0 };
+		drawGroupIndices.emplace(model.get(), draw);
+		drawGroupsChanged = true;
+		return draw;
+	}
+
+	void SimpleRenderSystem::releaseDrawGroup(uint32_t draw)
+	{
+		DrawGroup& group = drawGroups[draw];
+		assert(group.rendererCount > 0 && "Draw group has no renderers.");
+		if (--group.rendererCount == 0)
+		{
+			drawGroupIndices.erase(group.model.get());
+			group.model.reset();
+			freeDrawGroups.push_back(draw);
+		}
+		drawGroupsChanged = true;
+	}
+
+	void SimpleRenderSystem::updateDrawInfos()
+	{
+		// every model gets a range of the instance buffer as large as its number of renderers,
+		// this is per model and only done when renderers were added, removed or changed models
+		drawInfos.resize(drawGroups.size());
+		uint32_t firstInstance = 0;
+		for (size_t i = 0; i < drawGroups.size(); i++)
+		{
+			DrawInfo& info = drawInfos[i];
+			info = {};
+			if (drawGroups[i].model)
+			{
+				const VeMeshBuffer::Range& range = drawGroups[i].model->getMeshRange();
+				info.indexCount = range.indexCount;
+				info.firstIndex = range.firstIndex;
+				info.vertexOffset = range.vertexOffset;
+			}
+			info.firstInstance = firstInstance;
+			firstInstance += drawGroups[i].rendererCount;
+		}
+	}
+
+	void SimpleRenderSystem::cullGameObjects(FrameInfo& frameInfo)
+	{
+		FrameResources& frame = frames[frameInfo.frameIndex];
+		const uint32_t frameBit = 1u << frameInfo.frameIndex;
 
-		renderSystemLayout = VeDescriptorSetLayout::Builder(veDevice)
-			.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)
-			.addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+		// object buffers were replaced, baking also moves objects between buffers which changes their references
+		if (objectBufferVersion != objectManager.getObjectBufferVersion())
+		{
+			objectBufferVersion = objectManager.getObjectBufferVersion();
+			dirtyFrames = ALL_FRAMES;
+			for (uint32_t slot = 0; slot < static_cast<uint32_t>(cullEntries.size()); slot++)
+				cullEntries[slot].object = objectManager.getObjectReference(entryEntities[slot]);
+			staleFrames = ALL_FRAMES;
+		}
+		if (drawGroupsChanged)
+		{
+			updateDrawInfos();
+			drawGroupsChanged = false;
+			staleDrawFrames = ALL_FRAMES;
+		}
+
+		const uint32_t entryCount = static_cast<uint32_t>(cullEntries.size());
+		const uint32_t drawCount = static_cast<uint32_t>(drawGroups.size());
+		// it's safe to replace the buffers here since the gpu finished the last frame that used this index
+		if (reserveBuffer(frame.cullEntries, sizeof(CullEntry), entryCount,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+		{
+			staleFrames |= frameBit;
+			dirtyFrames |= frameBit;
+		}
+		if (reserveBuffer(frame.drawInfos, sizeof(DrawInfo), drawCount,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+		{
+			staleDrawFrames |= frameBit;
+			dirtyFrames |= frameBit;
+		}
+		const bool countersReplaced = reserveBuffer(frame.drawCounters, sizeof(uint32_t), drawCount + 1,
+			DRAW_COUNTER_USAGE, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		const bool commandsReplaced = reserveBuffer(frame.drawCommands, sizeof(VkDrawIndexedIndirectCommand), drawCount,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		const bool instancesReplaced = reserveBuffer(frame.instances, sizeof(InstanceData), entryCount,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		if (countersReplaced || commandsReplaced || instancesReplaced)
+			dirtyFrames |= frameBit;
+
+		if (staleFrames & frameBit)
+		{
+			if (entryCount > 0)
+				frame.cullEntries->writeToBuffer(cullEntries.data(), sizeof(CullEntry) * entryCount);
+			staleFrames &= ~frameBit;
+		}
+		else
+		{
+			// only the slots written since this frame was last recorded, removed slots past the end are dropped
+			for (uint32_t slot : frame.dirtyEntries)
+			{
+				if (slot < entryCount)
+					frame.cullEntries->writeToIndex(&cullEntries[slot], static_cast<int>(slot));
+			}
+		}
+		frame.dirtyEntries.clear();
+		if (staleDrawFrames & frameBit)
+		{
+			if (drawCount > 0)
+				frame.drawInfos->writeToBuffer(drawInfos.data(), sizeof(DrawInfo) * drawCount);
+			staleDrawFrames &= ~frameBit;
+		}
+		if (dirtyFrames & frameBit)
+		{
+			writeFrameSets(frameInfo.frameIndex);
+			dirtyFrames &= ~frameBit;
+		}
+		if (entryCount == 0)
+			return;
+
+		// the counters start at zero every frame, this is all the gpu needs from the cpu per frame
+		vkCmdFillBuffer(frameInfo.commandBuffer, frame.drawCounters->getBuffer(), 0, sizeof(uint32_t) * (drawCount + 1), 0);
+		VkMemoryBarrier clearBarrier{};
+		clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier(
+			frameInfo.commandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+		CullPushConstants push{};
+		computeFrustumPlanes(frameInfo.camera.getProjection() * frameInfo.camera.getView(), push.frustumPlanes);
+		push.entryCount = entryCount;
+		push.drawCount = drawCount;
+
+		cullPipeline->bind(frameInfo.commandBuffer);
+		vkCmdBindDescriptorSets(
+			frameInfo.commandBuffer,
+			VK_PIPELINE_BIND_POINT_COMPUTE,
+			cullPipelineLayout,
+			0, 1, &frame.cullSet, 0, nullptr);
+		vkCmdPushConstants(frameInfo.commandBuffer, cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstants), &push);
+		vkCmdDispatch(frameInfo.commandBuffer, (entryCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+		// the compact pass reads the instance counts of the cull pass, the set and push constants
+		// stay bound since both pipelines share the layout
+		VkMemoryBarrier countBarrier{};
+		countBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		countBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		countBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier(
+			frameInfo.commandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0, 1, &countBarrier, 0, nullptr, 0, nullptr);
+		compactPipeline->bind(frameInfo.commandBuffer);
+		vkCmdDispatch(frameInfo.commandBuffer, (drawCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+		// the draw reads the commands and their count, the vertex shader the written instances
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(
+			frameInfo.commandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+			0, 1, &barrier, 0, nullptr, 0, nullptr);
+	}
+
+	void SimpleRenderSystem::createPipelineLayout(VkDescriptorSetLayout globalSetLayout)
+	{
+		objectSetLayout = VeDescriptorSetLayout::Builder(veDevice)
+			.addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
+			.addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
+			.addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
 			.build();
 
-		std::vector<VkDescriptorSetLayout> descriptorSetLayouts{ globalSetLayout, renderSystemLayout->getDescriptorSetLayout() };
+		std::vector<VkDescriptorSetLayout> descriptorSetLayouts{
+			globalSetLayout,
+			objectSetLayout->getDescriptorSetLayout(),
+			textureTable.getSetLayout() };
 
 		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
 		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 		pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
 		pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
-		pipelineLayoutInfo.pushConstantRangeCount = 1;
-		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+		pipelineLayoutInfo.pushConstantRangeCount = 0;
+		pipelineLayoutInfo.pPushConstantRanges = nullptr;
 		if (vkCreatePipelineLayout(veDevice.device(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
 			throw std::runtime_error("failed to create pipeline layout!");
 	}
@@ -65,54 +465,38 @@ namespace ve
 	{
 		vePipeline->bind(frameInfo.commandBuffer);
 
-		glm::mat4 projectionView = frameInfo.camera.getProjection() * frameInfo.camera.getView();
-
 		vkCmdBindDescriptorSets(
 			frameInfo.commandBuffer,
 			VK_PIPELINE_BIND_POINT_GRAPHICS,
 			pipelineLayout,
 			0, 1, &frameInfo.globalDescriptorSet, 0, nullptr);
+		if (cullEntries.empty())
+			return;
 
-		for (entity_t entity : frameInfo.entityManager.getEntities<RendererComponent>())
-		{
-			const TransformComponent& transComp = frameInfo.entityManager.GetComponent<TransformComponent>(entity);
-			const RendererComponent& renderComp = frameInfo.entityManager.GetComponent<RendererComponent>(entity);
-
-
-			// writing descriptor set each frame can slow performance
-			// would be more efficient to implement some sort of caching
-			VkDescriptorBufferInfo bufferInfo = frameInfo.entityManager.getBufferInfoForGameObject(frameInfo.frameIndex, entity);
-			VkDescriptorImageInfo imageInfo = renderComp.diffuseMap->getImageInfo();
-			VkDescriptorSet objectDescriptorSet;
-			VeDescriptorWriter(*renderSystemLayout, frameInfo.frameDescriptorPool)
-				.writeBuffer(0, &bufferInfo)
-				.writeImage(1, &imageInfo)
-				.build(objectDescriptorSet);
-
-			vkCmdBindDescriptorSets(
-				frameInfo.commandBuffer,
-				VK_PIPELINE_BIND_POINT_GRAPHICS,
-				pipelineLayout,
-				1,  // starting set (0 is the globalDescriptorSet, 1 is the set specific to this system)
-				1,  // set count
-				&objectDescriptorSet,
-				0,
-				nullptr);
-
-			SimplePushConstantData push{};
-			push.modelMatrix = transComp.mat4();
-			push.normalMatrix = transComp.normalMatrix();
-
-			vkCmdPushConstants(
-				frameInfo.commandBuffer,
-				pipelineLayout,
-				VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-				0,
-				sizeof(SimplePushConstantData),
-				&push);
-			renderComp.model->bind(frameInfo.commandBuffer);
-			renderComp.model->draw(frameInfo.commandBuffer);
-		}
+		// the object set and the texture table are the only sets, both are bound once for the frame
+		FrameResources& frame = frames[frameInfo.frameIndex];
+		std::array<VkDescriptorSet, 2> frameSets{ frame.objectSet, textureTable.getSet() };
+		vkCmdBindDescriptorSets(
+			frameInfo.commandBuffer,
+			VK_PIPELINE_BIND_POINT_GRAPHICS,
+			pipelineLayout,
+			1,  // starting set (0 is the globalDescriptorSet, 1 is the object set, 2 the texture table)
+			static_cast<uint32_t>(frameSets.size()),
+			frameSets.data(),
+			0,
+			nullptr);
+
+		// every model lives in the mesh buffer, the cull passes wrote a command for each model with
+		// visible instances and the number of those commands
+		meshBuffer.bind(frameInfo.commandBuffer);
+		vkCmdDrawIndexedIndirectCount(
+			frameInfo.commandBuffer,
+			frame.drawCommands->getBuffer(),
+			0,
+			frame.drawCounters->getBuffer(),
+			0,
+			static_cast<uint32_t>(drawGroups.size()),
+			sizeof(VkDrawIndexedIndirectCommand));
 	}
 
 }
\ No newline at end of file
@@ -3,9 +3,15 @@
 #include "ve_frame_info.h"
 #include "ve_pipeline.h"
 #include "ve_components.h"
+#include "ve_buffer.h"
+#include "ve_texture_table.h"
+#include "ve_mesh_buffer.h"
 
 // std
+#include <array>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace ve
 {
@@ -15,21 +21,145 @@ namespace ve
 		static constexpr int WIDTH = 800;
 		static constexpr int HEIGHT = 600;
 
-		SimpleRenderSystem(VeDevice& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout);
+		SimpleRenderSystem(VeDevice& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout, VeObjectManager& objectManager, VeTextureTable& textureTable, VeMeshBuffer& meshBuffer);
 		~SimpleRenderSystem();
 
 		SimpleRenderSystem(const SimpleRenderSystem&) = delete;
 		SimpleRenderSystem& operator=(const SimpleRenderSystem&) = delete;
+		// frustum culls every renderer on the gpu and writes the frame's indirect draw commands and
+		// their count, has to be recorded before the render pass begins
+		void cullGameObjects(FrameInfo& frameInfo);
 		void renderGameObjects(FrameInfo& frameInfo);
 	private:
+		// element of the instance buffer, laid out like InstanceData in simple_shader.vert
+		struct InstanceData
+		{
+			uint32_t object;
+			uint32_t texture;
+		};
+
+		// one per renderer, laid out like CullEntry in cull.comp. draw is the renderer's model in drawGroups
+		struct CullEntry
+		{
+			glm::vec4 boundingSphere;
+			uint32_t object;
+			uint32_t texture;
+			uint32_t draw;
+			uint32_t padding;
+		};
+
+		// one per model, laid out like DrawInfo in cull.comp. everything of the model's indirect command
+		// but the instance count, which the cull pass counts
+		struct DrawInfo
+		{
+			uint32_t indexCount;
+			uint32_t firstIndex;
+			int32_t vertexOffset;
+			uint32_t firstInstance;
+		};
+
+		struct CullPushConstants
+		{
+			glm::vec4 frustumPlanes[6];
+			uint32_t entryCount;
+			uint32_t drawCount;
+		};
+
+		// the draw of one model, its instances get a range of the instance buffer as large as its number of renderers
+		struct DrawGroup
+		{
+			std::shared_ptr<VeModel> model;
+			uint32_t rendererCount;
+		};
+
+		struct FrameResources
+		{
+			// copy of cullEntries, the slots written since the frame was last recorded are uploaded
+			std::unique_ptr<VeBuffer> cullEntries;
+			std::vector<uint32_t> dirtyEntries;
+			// copy of drawInfos, uploaded when a draw group changed
+			std::unique_ptr<VeBuffer> drawInfos;
+			// the number of draws followed by the instance count of every draw, cleared before the cull pass
+			std::unique_ptr<VeBuffer> drawCounters;
+			// written by the compact pass, only draws with visible instances get a command
+			std::unique_ptr<VeBuffer> drawCommands;
+			// written by the cull pass, the instances of each draw are packed from its firstInstance
+			std::unique_ptr<VeBuffer> instances;
+			VkDescriptorSet objectSet = VK_NULL_HANDLE;
+			VkDescriptorSet cullSet = VK_NULL_HANDLE;
+		};
+
+		static constexpr uint32_t INITIAL_INSTANCE_CAPACITY = 1024;
+		static constexpr uint32_t INITIAL_DRAW_CAPACITY = 64;
+		static constexpr uint32_t CULL_GROUP_SIZE = 64;
+		static constexpr uint32_t ALL_FRAMES = (1u << VeSwapChain::MAX_FRAMES_IN_FLIGHT) - 1;
+		static constexpr uint32_t INVALID_SLOT = ~0u;
+		// cleared with vkCmdFillBuffer, counted up by the cull passes and read by the draw
+		static constexpr VkBufferUsageFlags DRAW_COUNTER_USAGE =
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
 		void createPipelineLayout(VkDescriptorSetLayout globalSetLayout);
 		void createPipeline(VkRenderPass renderPass);
+		void createCullPipeline();
+		void createFrameResources();
+		// the buffer is replaced by a larger one when it holds less than count instances, returns true then
+		bool reserveBuffer(std::unique_ptr<VeBuffer>& buffer, VkDeviceSize instanceSize, uint32_t count,
+			VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags memoryPropertyFlags);
+		void writeFrameSets(int frameIndex);
+		// entries are kept in place and only the renderers that changed are written, a removed
+		// entry is replaced by the last one
+		void addRenderers(const entity_t* entities, int32_t count);
+		void removeRenderers(const entity_t* entities, int32_t count);
+		void writeCullEntry(entity_t entity, uint32_t slot);
+		void markEntryDirty(uint32_t slot);
+		uint32_t findDrawGroup(const std::shared_ptr<VeModel>& model);
+		void releaseDrawGroup(uint32_t draw);
+		void updateDrawInfos();
 
 		VeDevice& veDevice;
+		VeObjectManager& objectManager;
+		VeTextureTable& textureTable;
+		VeMeshBuffer& meshBuffer;
 
 		std::unique_ptr<VePipeline> vePipeline;
 		VkPipelineLayout pipelineLayout;
 
-		std::unique_ptr<VeDescriptorSetLayout> renderSystemLayout;
+		// the cull pass counts the visible instances of every draw, the compact pass turns the draws
+		// with instances into commands and counts them for vkCmdDrawIndexedIndirectCount
+		std::unique_ptr<VeComputePipeline> cullPipeline;
+		std::unique_ptr<VeComputePipeline> compactPipeline;
+		VkPipelineLayout cullPipelineLayout;
+
+		// set 1 holds the frame's object buffer, the static object buffer and the instance buffer,
+		// set 2 is the texture table. the cull set holds the object buffers and the frame's cull buffers
+		std::unique_ptr<VeDescriptorSetLayout> objectSetLayout;
+		std::unique_ptr<VeDescriptorSetLayout> cullSetLayout;
+
+		// set i and the buffers of frame i are only written while frame i is recorded,
+		// after its fence was waited on
+		std::unique_ptr<VeDescriptorPool> framePool;
+		std::array<FrameResources, VeSwapChain::MAX_FRAMES_IN_FLIGHT> frames;
+		// one bit per frame whose sets still point at replaced buffers
+		uint32_t dirtyFrames = ALL_FRAMES;
+		// one bit per frame whose cull entries have to be uploaded as a whole
+		uint32_t staleFrames = ALL_FRAMES;
+		// one bit per frame whose draw infos are older than drawInfos
+		uint32_t staleDrawFrames = ALL_FRAMES;
+		uint32_t objectBufferVersion = 0;
+
+		// kept up to date by the renderer observers, so frames where nothing changed cost the same
+		// whatever the number of objects and a change costs as much as the renderers it touched
+		std::array<ObserverID, 3> observers{};
+		std::vector<CullEntry> cullEntries;
+		std::vector<entity_t> entryEntities;
+		// entity -> its slot in cullEntries, INVALID_SLOT without a renderer
+		std::vector<uint32_t> entrySlots;
+		// a group losing its last renderer drops its model and is reused by the next new model,
+		// so the draw indices of the other entries stay valid
+		std::vector<DrawGroup> drawGroups;
+		std::vector<uint32_t> freeDrawGroups;
+		std::unordered_map<const VeModel*, uint32_t> drawGroupIndices;
+		std::vector<DrawInfo> drawInfos;
+		bool drawGroupsChanged = true;
 	};
 }
\ No newline at end of file
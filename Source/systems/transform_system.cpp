@@ -0,0 +1,211 @@
+#include "transform_system.h"
+
+// std
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace ve
+{
+	static_assert(sizeof(glm::mat4) == sizeof(TransformMatrices::model) && sizeof(glm::mat3) == sizeof(TransformMatrices::normal),
+		"Batch kernel output has to match the glm matrix layout.");
+
+	void TransformSystem::update(SceneEntityManager& entityManager)
+	{
+		entityManager.takeChanges<TransformComponent>(dirty);
+		entityManager.takeChanges<HierarchyComponent>(hierarchyChanges);
+		entityManager.takeChanges<MobilityComponent>(mobilityChanges);
+
+		// links or mobility changed or entities came and went, sort again and recompute everything once.
+		// the structure versions catch added and removed components, even when as many world transforms
+		// were added as removed
+		const std::array<uint32_t, 3> versions = { entityManager.getStructureVersion<WorldTransformComponent>(),
+			entityManager.getStructureVersion<HierarchyComponent>(), entityManager.getStructureVersion<MobilityComponent>() };
+		bool structureChanged = versions != structureVersions;
+		structureVersions = versions;
+		for (uint64_t word : hierarchyChanges)
+			structureChanged |= word != 0;
+		for (uint64_t word : mobilityChanges)
+			structureChanged |= word != 0;
+
+		auto isDirty = [this](entity_t entity) { return (dirty[entity >> 6] >> (entity & 63)) & 1; };
+		if (structureChanged)
+		{
+			rebuildOrder(entityManager);
+			std::fill(dirty.begin(), dirty.end(), ~uint64_t(0));
+		}
+		else
+		{
+#ifndef NDEBUG
+			for (entity_t entity : staticEntities)
+				assert(!isDirty(entity) && "Transform of a static entity was modified, make it stationary or movable first.");
+#endif
+			if (std::none_of(dirty.begin(), dirty.end(), [](uint64_t word) { return word != 0; }))
+				return;
+		}
+
+		// collect the dirty entities, keeping the depth order. static entities can only
+		// change with the structure, so otherwise only the dynamic ones are visited
+		batchEntities.clear();
+		batchParents.clear();
+		for (entity_t entity : structureChanged ? order : dynamicOrder)
+		{
+			entity_t parent = entityManager.HasComponent<HierarchyComponent>(entity) ? entityManager.ReadComponent<HierarchyComponent>(entity).parent : -1;
+			// a parent without a world transform leaves its children at the root
+			if (parent != -1 && !entityManager.HasComponent<WorldTransformComponent>(parent))
+				parent = -1;
+			if (!isDirty(entity) && (parent == -1 || !isDirty(parent)))
+				continue;
+
+			// children further down the array see this entity as dirty too
+			dirty[entity >> 6] |= uint64_t(1) << (entity & 63);
+			batchEntities.push_back(entity);
+			batchParents.push_back(parent);
+		}
+
+		const int32_t count = static_cast<int32_t>(batchEntities.size());
+		if (count == 0)
+			return;
+
+		// an entity without a local transform sits where its parent is, its local matrix is the identity
+		static const TransformComponent identity{};
+		auto localOf = [&entityManager](entity_t entity) -> const TransformComponent&
+			{
+				return entityManager.HasComponent<TransformComponent>(entity) ? entityManager.ReadComponent<TransformComponent>(entity) : identity;
+			};
+
+		// euler and quaternion transforms go through their own kernel, euler ones first in batchMatrices
+		int32_t eulerCount = 0;
+		for (entity_t entity : batchEntities)
+			eulerCount += localOf(entity).rotationMode == RotationMode::EulerYXZ;
+		const int32_t quaternionCount = count - eulerCount;
+
+		// translation xyz, rotation xyz or orientation xyzw, scale xyz, each a column of floats
+		batchTransforms.resize(static_cast<size_t>(eulerCount) * 9 + static_cast<size_t>(quaternionCount) * 10);
+		float* eulerColumns[9];
+		float* quaternionColumns[10];
+		for (int32_t column = 0; column < 9; column++)
+			eulerColumns[column] = batchTransforms.data() + static_cast<size_t>(column) * eulerCount;
+		for (int32_t column = 0; column < 10; column++)
+			quaternionColumns[column] = batchTransforms.data() + static_cast<size_t>(eulerCount) * 9 + static_cast<size_t>(column) * quaternionCount;
+
+		batchSlots.resize(count);
+		int32_t eulerIndex = 0;
+		int32_t quaternionIndex = 0;
+		for (int32_t i = 0; i < count; i++)
+		{
+			const TransformComponent& local = localOf(batchEntities[i]);
+			if (local.rotationMode == RotationMode::EulerYXZ)
+			{
+				const int32_t slot = eulerIndex++;
+				for (int32_t axis = 0; axis < 3; axis++)
+				{
+					eulerColumns[axis][slot] = local.translation[axis];
+					eulerColumns[3 + axis][slot] = local.rotation[axis];
+					eulerColumns[6 + axis][slot] = local.scale[axis];
+				}
+				batchSlots[i] = slot;
+			}
+			else
+			{
+				const int32_t slot = quaternionIndex++;
+				for (int32_t axis = 0; axis < 3; axis++)
+				{
+					quaternionColumns[axis][slot] = local.translation[axis];
+					quaternionColumns[7 + axis][slot] = local.scale[axis];
+				}
+				quaternionColumns[3][slot] = local.orientation.x;
+				quaternionColumns[4][slot] = local.orientation.y;
+				quaternionColumns[5][slot] = local.orientation.z;
+				quaternionColumns[6][slot] = local.orientation.w;
+				batchSlots[i] = eulerCount + slot;
+			}
+		}
+
+		batchMatrices.resize(count);
+		const TransformBatch eulerBatch{
+			{ eulerColumns[0], eulerColumns[1], eulerColumns[2] },
+			{ eulerColumns[3], eulerColumns[4], eulerColumns[5] },
+			{ eulerColumns[6], eulerColumns[7], eulerColumns[8] } };
+		computeTransformMatrices(eulerBatch, eulerCount, batchMatrices.data());
+		const QuaternionTransformBatch quaternionBatch{
+			{ quaternionColumns[0], quaternionColumns[1], quaternionColumns[2] },
+			{ quaternionColumns[3], quaternionColumns[4], quaternionColumns[5], quaternionColumns[6] },
+			{ quaternionColumns[7], quaternionColumns[8], quaternionColumns[9] } };
+		computeTransformMatrices(quaternionBatch, quaternionCount, batchMatrices.data() + eulerCount);
+
+		// parents come first in the batch, so their world matrices are final when a child reads them
+		for (int32_t i = 0; i < count; i++)
+		{
+			glm::mat4 localMatrix;
+			glm::mat3 localNormal;
+			std::memcpy(&localMatrix, batchMatrices[batchSlots[i]].model, sizeof(localMatrix));
+			std::memcpy(&localNormal, batchMatrices[batchSlots[i]].normal, sizeof(localNormal));
+
+			const entity_t entity = batchEntities[i];
+			const entity_t parent = batchParents[i];
+			WorldTransformComponent result{ localMatrix, localNormal };
+			if (parent != -1)
+			{
+				// the inverse transpose of a product is the product of the inverse transposes
+				const WorldTransformComponent& parentWorld = entityManager.ReadComponent<WorldTransformComponent>(parent);
+				result.matrix = parentWorld.matrix * localMatrix;
+				result.normalMatrix = parentWorld.normalMatrix * localNormal;
+			}
+
+			// a full recompute after a structure change mostly yields the same matrices,
+			// only real changes are passed on so baked objects aren't baked again for nothing
+			const WorldTransformComponent& world = entityManager.ReadComponent<WorldTransformComponent>(entity);
+			if (world.matrix != result.matrix || world.normalMatrix != result.normalMatrix)
+				entityManager.GetComponent<WorldTransformComponent>(entity) = result;
+		}
+	}
+
+	void TransformSystem::rebuildOrder(SceneEntityManager& entityManager)
+	{
+		const std::vector<entity_t>& entities = entityManager.getEntities<WorldTransformComponent>();
+
+		auto depthOf = [&entityManager](entity_t entity)
+			{
+				return entityManager.HasComponent<HierarchyComponent>(entity) ? entityManager.ReadComponent<HierarchyComponent>(entity).depth : 0;
+			};
+
+		// counting sort on depth, stable so siblings keep the pool order
+		depthOffsets.assign(1, 0);
+		for (entity_t entity : entities)
+		{
+			const uint32_t depth = depthOf(entity);
+			if (depth + 2 > depthOffsets.size())
+				depthOffsets.resize(depth + 2, 0);
+			depthOffsets[depth + 1]++;
+		}
+		for (size_t depth = 1; depth < depthOffsets.size(); depth++)
+			depthOffsets[depth] += depthOffsets[depth - 1];
+
+		order.resize(entities.size());
+		for (entity_t entity : entities)
+			order[depthOffsets[depthOf(entity)]++] = entity;
+
+		// split off static entities, parents come first so a parent's dynamic flag is known before its children
+		dynamicBits.assign((entityManager.capacity() + 63) / 64, 0);
+		dynamicOrder.clear();
+		staticEntities.clear();
+		for (entity_t entity : order)
+		{
+			const entity_t parent = entityManager.HasComponent<HierarchyComponent>(entity) ? entityManager.ReadComponent<HierarchyComponent>(entity).parent : -1;
+			const bool parentMoves = parent != -1 && entityManager.HasComponent<WorldTransformComponent>(parent) && ((dynamicBits[parent >> 6] >> (parent & 63)) & 1);
+			const bool isStatic = entityManager.HasComponent<MobilityComponent>(entity)
+				&& entityManager.ReadComponent<MobilityComponent>(entity).mobility == Mobility::Static;
+			assert(!(isStatic && parentMoves) && "A static entity can't be attached to a parent that moves.");
+			if (isStatic && !parentMoves)
+			{
+				staticEntities.push_back(entity);
+			}
+			else
+			{
+				dynamicBits[entity >> 6] |= uint64_t(1) << (entity & 63);
+				dynamicOrder.push_back(entity);
+			}
+		}
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "ve_components.h"
+#include "ve_ecs_archetype.h"
+#include "ve_transform_batch.h"
+
+// std
+#include <array>
+#include <vector>
+
+namespace ve
+{
+	// keeps WorldTransformComponent up to date. entities are visited in a dense array sorted by
+	// hierarchy depth so parents are always done before their children, and only entities whose
+	// local transform or one of whose ancestors changed are recomputed. local matrices of the
+	// dirty entities are gathered into SoA arrays and computed with the batch matrix kernel.
+	// static entities are only recomputed when the hierarchy or a mobility changes
+	class TransformSystem
+	{
+	public:
+		void update(SceneEntityManager& entityManager);
+
+	private:
+		void rebuildOrder(SceneEntityManager& entityManager);
+
+		// entities with a world transform, sorted by depth
+		std::vector<entity_t> order;
+		// the non static part of order, the only entities visited when the structure didn't change
+		std::vector<entity_t> dynamicOrder;
+		std::vector<entity_t> staticEntities;
+		std::vector<uint64_t> dynamicBits;
+		std::vector<int32_t> depthOffsets;
+		std::vector<uint64_t> dirty;
+		std::vector<uint64_t> hierarchyChanges;
+		std::vector<uint64_t> mobilityChanges;
+		// structure versions of the world transforms, hierarchy and mobility when order was built
+		std::array<uint32_t, 3> structureVersions{};
+
+		// dirty entities in depth order with their parents and local transforms as SoA
+		std::vector<entity_t> batchEntities;
+		std::vector<entity_t> batchParents;
+		std::vector<float> batchTransforms;
+		std::vector<TransformMatrices> batchMatrices;
+		// index of each batch entity's matrices in batchMatrices
+		std::vector<int32_t> batchSlots;
+	};
+}
@@ -183,6 +183,26 @@ namespace ve
 		return flush(alignmentSize, index * alignmentSize); 
 	}
 
+	/**
+	 *  Flush count consecutive instances starting at firstIndex * alignmentSize in a single range
+	 *
+	 * @note The range is widened to whole nonCoherentAtomSize blocks, so tightly packed instances
+	 * can be flushed too. Neighbouring instances flushed along with it are flushed unchanged
+	 *
+	 * @param firstIndex Index of the first instance to flush
+	 * @param count Number of instances to flush
+	 *
+	 */
+	VkResult VeBuffer::flushIndexRange(int firstIndex, int count) {
+		const VkDeviceSize atomSize = veDevice.properties.limits.nonCoherentAtomSize;
+		const VkDeviceSize begin = firstIndex * alignmentSize / atomSize * atomSize;
+		const VkDeviceSize end = (static_cast<VkDeviceSize>(firstIndex + count) * alignmentSize + atomSize - 1) / atomSize * atomSize;
+		// the last block may reach past the buffer, the rest of the mapping is flushed then
+		if (end >= bufferSize)
+			return flush(VK_WHOLE_SIZE, begin);
+		return flush(end - begin, begin);
+	}
+
 	/**
 	 * Create a buffer info descriptor
 	 *
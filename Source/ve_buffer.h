@@ -30,6 +30,7 @@ namespace ve
 
 		void writeToIndex(void* data, int index);
 		VkResult flushIndex(int index);
+		VkResult flushIndexRange(int firstIndex, int count);
 		VkDescriptorBufferInfo descriptorInfoForIndex(int index);
 		VkResult invalidateIndex(int index);
 
@@ -37,7 +38,7 @@ namespace ve
 		void* getMappedMemory() const { return mapped; }
 		uint32_t getInstanceCount() const { return instanceCount; }
 		VkDeviceSize getInstanceSize() const { return instanceSize; }
-		VkDeviceSize getAlignmentSize() const { return instanceSize; }
+		VkDeviceSize getAlignmentSize() const { return alignmentSize; }
 		VkBufferUsageFlags getUsageFlags() const { return usageFlags; }
 		VkMemoryPropertyFlags getMemoryPropertyFlags() const { return memoryPropertyFlags; }
 		VkDeviceSize getBufferSize() const { return bufferSize; }
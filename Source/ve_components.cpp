@@ -4,6 +4,16 @@ namespace ve
 {
     glm::mat4 TransformComponent::mat4() const
     {
+		if (rotationMode == RotationMode::Quaternion)
+		{
+			const glm::mat3 rotationMatrix = glm::mat3_cast(orientation);
+			return glm::mat4{
+				glm::vec4(rotationMatrix[0] * scale.x, 0.0f),
+				glm::vec4(rotationMatrix[1] * scale.y, 0.0f),
+				glm::vec4(rotationMatrix[2] * scale.z, 0.0f),
+				glm::vec4(translation, 1.0f) };
+		}
+
         const float c3 = glm::cos(rotation.z);
         const float s3 = glm::sin(rotation.z);
         const float c2 = glm::cos(rotation.x);
@@ -34,6 +44,15 @@ namespace ve
 
 	glm::mat3 TransformComponent::normalMatrix() const
 	{
+		if (rotationMode == RotationMode::Quaternion)
+		{
+			const glm::mat3 rotationMatrix = glm::mat3_cast(orientation);
+			return glm::mat3{
+				rotationMatrix[0] / scale.x,
+				rotationMatrix[1] / scale.y,
+				rotationMatrix[2] / scale.z };
+		}
+
 		const float c3 = glm::cos(rotation.z);
 		const float s3 = glm::sin(rotation.z);
 		const float c2 = glm::cos(rotation.x);
@@ -59,4 +78,39 @@ namespace ve
 			} };
 	}
 
-}
\ No newline at end of file
+	void TransformComponent::setOrientation(const glm::quat& inOrientation)
+	{
+		orientation = inOrientation;
+		rotationMode = RotationMode::Quaternion;
+	}
+
+	glm::quat TransformComponent::getOrientation() const
+	{
+		return rotationMode == RotationMode::Quaternion ? orientation : eulerYXZToQuat(rotation);
+	}
+
+	void TransformComponent::rotate(const glm::vec3& angularVelocity, float deltaTime)
+	{
+		// dq/dt = 0.5 * w * q, first order step and renormalize so no sin/cos is needed
+		const glm::quat current = getOrientation();
+		const glm::quat spin{ 0.0f, angularVelocity.x, angularVelocity.y, angularVelocity.z };
+		setOrientation(glm::normalize(current + (spin * current) * (0.5f * deltaTime)));
+	}
+
+	glm::quat eulerYXZToQuat(const glm::vec3& rotation)
+	{
+		return glm::angleAxis(rotation.y, glm::vec3{ 0.0f, 1.0f, 0.0f })
+			* glm::angleAxis(rotation.x, glm::vec3{ 1.0f, 0.0f, 0.0f })
+			* glm::angleAxis(rotation.z, glm::vec3{ 0.0f, 0.0f, 1.0f });
+	}
+
+	glm::vec3 quatToEulerYXZ(const glm::quat& orientation)
+	{
+		// third column is (c2 * s1, -s2, c1 * c2), second row is (c2 * s3, c2 * c3, -s2)
+		const glm::mat3 m = glm::mat3_cast(orientation);
+		return glm::vec3{
+			glm::asin(glm::clamp(-m[2][1], -1.0f, 1.0f)),
+			glm::atan(m[2][0], m[2][2]),
+			glm::atan(m[0][1], m[1][1]) };
+	}
+}
@@ -1,21 +1,51 @@
 #pragma once
 
-#include "ve_model.h"
-#include "ve_texture.h"
+#include "ve_ecs.h"
 
 // libs
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 //std
 #include <memory>
+#include <string_view>
 #include <unordered_map>
 
 namespace ve
 {
-	class TagComponent
+	// renderers only hold references, so components don't pull in vulkan
+	class VeModel;
+	class VeTexture;
+
+	// interned name, the hash of the string. 0 is no name
+	typedef uint32_t NameID;
+	constexpr NameID NO_NAME = 0;
+
+	// 32 bit FNV-1a, stable between runs so hashes can be saved
+	inline uint32_t hashName(std::string_view name)
+	{
+		uint32_t hash = 2166136261u;
+		for (char c : name)
+		{
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
+	// the name string lives in VeObjectManager's name table, set it through VeObjectManager::setName
+	struct TagComponent
 	{
-	public:
-		char Name[32];
-		uint32_t Tag;
+		NameID name = NO_NAME;
+		// bitmask of up to 32 user defined tags
+		uint32_t tags = 0;
+	};
+
+	enum class RotationMode : uint32_t
+	{
+		// rotation holds trait-bryan angles
+		EulerYXZ,
+		// orientation holds a unit quaternion, matrices are built without trigonometry
+		Quaternion,
 	};
 
 	struct TransformComponent
@@ -23,12 +53,62 @@ namespace ve
 		glm::vec3 translation{};// (position offset)
 		glm::vec3 scale{ 1.0f, 1.0f, 1.0f };
 		glm::vec3 rotation{};
+		glm::quat orientation = glm::identity<glm::quat>();
+		RotationMode rotationMode = RotationMode::EulerYXZ;
 
 		// https://en.wikipedia.org/wiki/Euler_angles#Rotation_matrix
 		// matrix is : translate * Ry * Rx * Rz * scale tranformation
 		// rotation convention uses trait-bryan angles with axis order Y(1), X(2), Z(3)
 		glm::mat4 mat4() const;
 		glm::mat3 normalMatrix() const;
+
+		// switches to quaternion mode
+		void setOrientation(const glm::quat& inOrientation);
+		// the rotation as a quaternion in either mode
+		glm::quat getOrientation() const;
+		// integrates an angular velocity (world space axis * radians per second) over deltaTime
+		// in quaternion space, switches to quaternion mode
+		void rotate(const glm::vec3& angularVelocity, float deltaTime);
+	};
+
+	// conversions between trait-bryan YXZ angles and quaternions, Ry * Rx * Rz == q
+	glm::quat eulerYXZToQuat(const glm::vec3& rotation);
+	glm::vec3 quatToEulerYXZ(const glm::quat& orientation);
+
+	// parent/children links, the children of an entity form a doubly linked list of siblings.
+	// change it through VeObjectManager::setParent so links and depth stay consistent
+	struct HierarchyComponent
+	{
+		entity_t parent = -1;
+		entity_t firstChild = -1;
+		entity_t nextSibling = -1;
+		entity_t prevSibling = -1;
+		// number of ancestors, roots are at depth 0
+		uint32_t depth = 0;
+	};
+
+	// cached local to world matrices, written by TransformSystem from the local transform
+	// and the parent's world transform. read this instead of calling TransformComponent::mat4()
+	struct WorldTransformComponent
+	{
+		glm::mat4 matrix{ 1.0f };
+		glm::mat3 normalMatrix{ 1.0f };
+	};
+
+	enum class Mobility : uint32_t
+	{
+		// never moves once placed, its matrices are baked once into a device local buffer
+		Static,
+		// moves rarely, baked like a static object and baked again when it moves
+		Stationary,
+		// written to the per frame object buffer whenever it changes
+		Movable,
+	};
+
+	// entities without one are movable. change it through VeObjectManager::setMobility
+	struct MobilityComponent
+	{
+		Mobility mobility = Mobility::Movable;
 	};
 
 	struct PointLightComponent
@@ -24,22 +24,44 @@ namespace ve {
 		return *this;
 	}
 
+	VeDescriptorSetLayout::Builder& VeDescriptorSetLayout::Builder::setBindingFlags(
+		uint32_t binding, VkDescriptorBindingFlags flags) {
+		assert(bindings.count(binding) == 1 && "Layout does not contain specified binding");
+		bindingFlags[binding] = flags;
+		return *this;
+	}
+
 	std::unique_ptr<VeDescriptorSetLayout> VeDescriptorSetLayout::Builder::build() const {
-		return std::make_unique<VeDescriptorSetLayout>(veDevice, bindings);
+		return std::make_unique<VeDescriptorSetLayout>(veDevice, bindings, bindingFlags);
 	}
 
 	// *************** Descriptor Set Layout *********************
 
 	VeDescriptorSetLayout::VeDescriptorSetLayout(
-		VeDevice& veDevice, std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings)
+		VeDevice& veDevice,
+		std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings,
+		const std::unordered_map<uint32_t, VkDescriptorBindingFlags>& bindingFlags)
 		: veDevice{ veDevice }, bindings{ bindings } {
 		std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings{};
+		std::vector<VkDescriptorBindingFlags> setLayoutBindingFlags{};
+		VkDescriptorSetLayoutCreateFlags layoutFlags = 0;
 		for (auto kv : bindings) {
 			setLayoutBindings.push_back(kv.second);
+			auto flags = bindingFlags.find(kv.first);
+			setLayoutBindingFlags.push_back(flags != bindingFlags.end() ? flags->second : 0);
+			if (setLayoutBindingFlags.back() & VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT)
+				layoutFlags |= VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
 		}
 
+		VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+		bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+		bindingFlagsInfo.bindingCount = static_cast<uint32_t>(setLayoutBindingFlags.size());
+		bindingFlagsInfo.pBindingFlags = setLayoutBindingFlags.data();
+
 		VkDescriptorSetLayoutCreateInfo descriptorSetLayoutInfo{};
 		descriptorSetLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		descriptorSetLayoutInfo.pNext = bindingFlags.empty() ? nullptr : &bindingFlagsInfo;
+		descriptorSetLayoutInfo.flags = layoutFlags;
 		descriptorSetLayoutInfo.bindingCount = static_cast<uint32_t>(setLayoutBindings.size());
 		descriptorSetLayoutInfo.pBindings = setLayoutBindings.data();
 
@@ -178,6 +200,28 @@ namespace ve {
 		return *this;
 	}
 
+	VeDescriptorWriter& VeDescriptorWriter::writeImage(
+		uint32_t binding, uint32_t arrayElement, VkDescriptorImageInfo* imageInfo) {
+		assert(setLayout.bindings.count(binding) == 1 && "Layout does not contain specified binding");
+
+		auto& bindingDescription = setLayout.bindings[binding];
+
+		assert(
+			arrayElement < bindingDescription.descriptorCount &&
+			"Array element is out of the binding's range");
+
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.descriptorType = bindingDescription.descriptorType;
+		write.dstBinding = binding;
+		write.dstArrayElement = arrayElement;
+		write.pImageInfo = imageInfo;
+		write.descriptorCount = 1;
+
+		writes.push_back(write);
+		return *this;
+	}
+
 	bool VeDescriptorWriter::build(VkDescriptorSet& set) {
 		bool success = pool.allocateDescriptor(setLayout.getDescriptorSetLayout(), set);
 		if (!success) {
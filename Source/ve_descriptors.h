@@ -20,15 +20,21 @@ namespace ve {
 				VkDescriptorType descriptorType,
 				VkShaderStageFlags stageFlags,
 				uint32_t count = 1);
+			// descriptor indexing flags of an added binding, update after bind bindings make
+			// the layout require an update after bind pool
+			Builder& setBindingFlags(uint32_t binding, VkDescriptorBindingFlags flags);
 			std::unique_ptr<VeDescriptorSetLayout> build() const;
 
 		private:
 			VeDevice& veDevice;
 			std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings{};
+			std::unordered_map<uint32_t, VkDescriptorBindingFlags> bindingFlags{};
 		};
 
 		VeDescriptorSetLayout(
-			VeDevice& veDevice, std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings);
+			VeDevice& veDevice,
+			std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings,
+			const std::unordered_map<uint32_t, VkDescriptorBindingFlags>& bindingFlags = {});
 		~VeDescriptorSetLayout();
 		VeDescriptorSetLayout(const VeDescriptorSetLayout&) = delete;
 		VeDescriptorSetLayout& operator=(const VeDescriptorSetLayout&) = delete;
@@ -90,6 +96,8 @@ namespace ve {
 
 		VeDescriptorWriter& writeBuffer(uint32_t binding, VkDescriptorBufferInfo* bufferInfo);
 		VeDescriptorWriter& writeImage(uint32_t binding, VkDescriptorImageInfo* imageInfo);
+		// writes a single element of an array binding
+		VeDescriptorWriter& writeImage(uint32_t binding, uint32_t arrayElement, VkDescriptorImageInfo* imageInfo);
 
 		bool build(VkDescriptorSet& set);
 		void overwrite(VkDescriptorSet& set);
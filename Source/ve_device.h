@@ -8,6 +8,8 @@
 
 namespace ve
 {
+    class VeTextureTable;
+    class VeMeshBuffer;
 
     struct SwapChainSupportDetails
     {
@@ -64,7 +66,7 @@ namespace ve
             VkDeviceMemory &bufferMemory);
         VkCommandBuffer beginSingleTimeCommands();
         void endSingleTimeCommands(VkCommandBuffer commandBuffer);
-        void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+        void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize dstOffset = 0);
         void copyBufferToImage(
             VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount);
 
@@ -86,6 +88,12 @@ namespace ve
 
         VkPhysicalDeviceProperties properties;
 
+        // set by the texture table while it exists, textures register into it when they are created
+        VeTextureTable* getTextureTable() const { return textureTable; }
+        void setTextureTable(VeTextureTable* table) { textureTable = table; }
+        VeMeshBuffer* getMeshBuffer() const { return meshBuffer; }
+        void setMeshBuffer(VeMeshBuffer* buffer) { meshBuffer = buffer; }
+
     private:
         void createInstance();
         void setupDebugMessenger();
@@ -114,6 +122,8 @@ namespace ve
         VkSurfaceKHR surface_;
         VkQueue graphicsQueue_;
         VkQueue presentQueue_;
+        VeTextureTable* textureTable = nullptr;
+        VeMeshBuffer* meshBuffer = nullptr;
 
         const std::vector<const char *> validationLayers = {"VK_LAYER_KHRONOS_validation"};
         const std::vector<const char *> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
@@ -4,11 +4,27 @@
 #include <glm/glm.hpp>
 
 // std
+#include <atomic>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <functional>
 #include <memory>
-#include <unordered_set>
+#include <new>
+#include <numeric>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 #include <unordered_map>
 #include <cassert>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VE_ECS_SSE2 1
+#include <emmintrin.h>
+#endif
+
 namespace internal
 {
 	struct FInternalComponentID
@@ -24,6 +40,8 @@ namespace internal
 namespace ve
 {
 	typedef int32_t entity_t;
+	// one bit per component type id
+	typedef uint64_t ComponentMask;
 
 	template<typename ComponentType>
 	struct ComponentTypeSquence
@@ -35,83 +53,217 @@ namespace ve
 		}
 	};
 
-	template<typename ElementType>
-	class SimpleSparseArray
+	template<typename... ComponentTypes>
+	ComponentMask getComponentMask()
+	{
+		return ((ComponentMask(1) << ComponentTypeSquence<std::remove_const_t<ComponentTypes>>::value()) | ... | ComponentMask(0));
+	}
+
+	// appends every index whose signature contains all bits of mask. destroyed entities keep an
+	// empty signature so a non empty mask never matches them
+	inline void filterSignatures(const ComponentMask* signatures, int32_t count, ComponentMask mask, std::vector<entity_t>& outEntities)
+	{
+		assert(mask != 0 && "Empty mask would match destroyed entities.");
+		int32_t index = 0;
+#if VE_ECS_SSE2
+		// two signatures per register, sse2 has no 64 bit compare so both 32 bit halves have to match
+		const __m128i maskVector = _mm_set1_epi64x(static_cast<long long>(mask));
+		for (; index + 2 <= count; index += 2)
+		{
+			const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(signatures + index));
+			const int matched = _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(values, maskVector), maskVector));
+			if (matched == 0)
+				continue;
+			if ((matched & 0x00FF) == 0x00FF)
+				outEntities.push_back(index);
+			if ((matched & 0xFF00) == 0xFF00)
+				outEntities.push_back(index + 1);
+		}
+#endif
+		for (; index < count; index++)
+		{
+			if ((signatures[index] & mask) == mask)
+				outEntities.push_back(index);
+		}
+	}
+
+	// growable array that allocates its elements in fixed size pages. growing only adds pages
+	// and never moves existing elements, so references stay valid until the element is removed.
+	template<typename ElementType, int32_t PageSize = 1024>
+	class PagedArray
 	{
+		static_assert((PageSize & (PageSize - 1)) == 0, "Page size must be a power of two.");
+		static constexpr int32_t PAGE_SHIFT = std::countr_zero(static_cast<uint32_t>(PageSize));
+		static constexpr int32_t PAGE_MASK = PageSize - 1;
+
+		struct Page
+		{
+			alignas(ElementType) unsigned char bytes[sizeof(ElementType) * PageSize];
+		};
+
 	public:
-		SimpleSparseArray(int numOfElements)
+		PagedArray() = default;
+		PagedArray(const PagedArray&) = delete;
+		PagedArray& operator=(const PagedArray&) = delete;
+
+		~PagedArray()
 		{
-			elements.resize(numOfElements);
-			checkList.resize(numOfElements, 0);
-			num = 0;
+			clear();
 		}
 
-		int32_t add()
+		ElementType& operator[](int32_t index)
 		{
-			int32_t index = -1;
-			while (++index < checkList.size() && checkList[index]) {}
-			assert(index < checkList.size() && "Trying to add more elements that array can handle.");
-			elements[index] = ElementType();
-			checkList[index] = 1;
+			return elementsOf(index >> PAGE_SHIFT)[index & PAGE_MASK];
+		}
+
+		template<typename... Args>
+		ElementType& emplace_back(Args&&... args)
+		{
+			if (num == capacity())
+				pages.push_back(std::unique_ptr<Page>(new Page));
+
+			ElementType* element = &(*this)[num];
+			new (element) ElementType(std::forward<Args>(args)...);
 			num++;
-			return index;
+			return *element;
 		}
 
-		void removeAt(int32_t index)
+		void pop_back()
 		{
-			checkList[index] = 0;
-			num--;
+			assert(num > 0 && "Trying to remove from an empty array.");
+			(*this)[--num].~ElementType();
 		}
 
-		void reset()
+		void clear()
 		{
-			std::fill(checkList.begin(), checkList.end(), 0);
+			if constexpr (!std::is_trivially_destructible_v<ElementType>)
+			{
+				for (int32_t i = 0; i < num; i++)
+					(*this)[i].~ElementType();
+			}
 			num = 0;
 		}
 
-		ElementType& operator[](int32_t index)
+		void reserve(int32_t count)
 		{
-			return elements[index];
+			while (capacity() < count)
+				pages.push_back(std::unique_ptr<Page>(new Page));
+		}
+
+		// bulk copy of count elements to the end, one memcpy per touched page
+		void append(const ElementType* source, int32_t count)
+		{
+			static_assert(std::is_trivially_copyable_v<ElementType>, "Bulk append needs trivially copyable elements.");
+			reserve(num + count);
+			while (count > 0)
+			{
+				const int32_t offset = num & PAGE_MASK;
+				const int32_t chunk = std::min(PageSize - offset, count);
+				std::memcpy(elementsOf(num >> PAGE_SHIFT) + offset, source, sizeof(ElementType) * chunk);
+				num += chunk;
+				source += chunk;
+				count -= chunk;
+			}
+		}
+
+		// count copies of value at the end, filled page by page
+		void appendCopies(const ElementType& value, int32_t count)
+		{
+			reserve(num + count);
+			while (count > 0)
+			{
+				const int32_t offset = num & PAGE_MASK;
+				const int32_t chunk = std::min(PageSize - offset, count);
+				std::uninitialized_fill_n(elementsOf(num >> PAGE_SHIFT) + offset, chunk, value);
+				num += chunk;
+				count -= chunk;
+			}
+		}
+
+		// copies all elements into a contiguous destination
+		void copyTo(ElementType* destination)
+		{
+			static_assert(std::is_trivially_copyable_v<ElementType>, "Bulk copy needs trivially copyable elements.");
+			for (int32_t page = 0; page < pageCount(); page++)
+			{
+				const int32_t first = page << PAGE_SHIFT;
+				std::memcpy(destination + first, elementsOf(page), sizeof(ElementType) * std::min(PageSize, num - first));
+			}
+		}
+
+		int32_t size() const
+		{
+			return num;
+		}
+
+		int32_t capacity() const
+		{
+			return static_cast<int32_t>(pages.size()) * PageSize;
+		}
+
+		// contiguous elements of a page, the last page only holds size() % PageSize of them
+		ElementType* elementsOf(int32_t page)
+		{
+			return std::launder(reinterpret_cast<ElementType*>(pages[page]->bytes));
+		}
+
+		int32_t pageCount() const
+		{
+			return (num + PAGE_MASK) >> PAGE_SHIFT;
 		}
 
 		class Iterator
 		{
 		public:
-			Iterator(SimpleSparseArray& inArray, int32_t index = 0) : sparseArray(inArray)
+			Iterator(PagedArray& inArray, int32_t inIndex) : array(inArray), index(inIndex)
 			{
-				currentIndex = index;
-				while (currentIndex < sparseArray.checkList.size() && !sparseArray.checkList[currentIndex]) { currentIndex++; }
+				page = index < array.num ? array.elementsOf(index >> PAGE_SHIFT) : nullptr;
 			}
 
 			Iterator& operator++()
 			{
-				while (++currentIndex < sparseArray.checkList.size() && !sparseArray.checkList[currentIndex]) {}
+				if ((++index & PAGE_MASK) == 0 && index < array.num)
+					page = array.elementsOf(index >> PAGE_SHIFT);
 				return *this;
 			}
 
 			ElementType& operator*() const
 			{
-				return sparseArray[currentIndex];
+				return page[index & PAGE_MASK];
 			}
 
-			explicit operator bool() const
-			{
-				currentIndex < sparseArray.checkList.size();
-			}
+			bool operator!=(const Iterator& rhs) const { return index != rhs.index; }
 
-			bool operator!=(const Iterator rhs) const { return currentIndex != rhs.currentIndex; }
-			int32_t currentIndex;
-			SimpleSparseArray& sparseArray;
+		private:
+			PagedArray& array;
+			ElementType* page;
+			int32_t index;
 		};
 
-		typename Iterator begin() { return Iterator(*this); }
-		typename Iterator end() { return Iterator(*this, checkList.size()); }
+		Iterator begin() { return Iterator(*this, 0); }
+		Iterator end() { return Iterator(*this, num); }
 
-		std::vector<ElementType> elements;
-		std::vector<uint8_t> checkList;
-		int32_t num;
+	private:
+		std::vector<std::unique_ptr<Page>> pages;
+		int32_t num = 0;
 	};
 
+	// events a component observer can listen to, usable as a mask
+	enum ComponentEvent : uint32_t
+	{
+		COMPONENT_ADDED = 1,
+		COMPONENT_REMOVED = 2,
+		// the component was accessed mutably, see markChanged
+		COMPONENT_UPDATED = 4,
+	};
+
+	// receives every entity that got the event since the last flush in one call
+	typedef std::function<void(const entity_t* entities, int32_t count)> ComponentObserver;
+	// handle of a registered observer, unique per pool
+	typedef uint32_t ObserverID;
+	// called by destroyEntity while the entity still has all of its components
+	typedef std::function<void(entity_t entity)> DestroyHook;
+
 	class ComponentPoolBase
 	{
 	public:
@@ -126,46 +278,271 @@ namespace ve
 
 		virtual void resetPool() = 0;
 
-		std::unordered_set<entity_t> ownerEntities;
-		std::vector<entity_t> entitiesArray;
+		int32_t size() const
+		{
+			return static_cast<int32_t>(ownerEntities.size());
+		}
+
+		// bumped whenever components are added or removed, for caches of the set of owners
+		uint32_t getStructureVersion() const
+		{
+			return structureVersion;
+		}
+
+		void addEntitySlot()
+		{
+			addEntitySlots(1);
+		}
+
+		void addEntitySlots(int32_t count)
+		{
+			entitiesArray.resize(entitiesArray.size() + count, -1);
+			changedBits.resize((entitiesArray.size() + 63) / 64, 0);
+			if (observedEvents & COMPONENT_UPDATED)
+				updatedBits.resize(changedBits.size(), 0);
+		}
+
+		// sets the number of entity slots of an empty pool
+		void resizeEntitySlots(int32_t numOfEntities)
+		{
+			assert(ownerEntities.empty() && "Entity slots can only be resized on an empty pool.");
+			// queued additions are checked with has() when flushed, drop the ones past the new slots
+			std::erase_if(addedEntities, [numOfEntities](entity_t entity) { return entity >= numOfEntities; });
+			entitiesArray.assign(numOfEntities, -1);
+			changedBits.assign((numOfEntities + 63) / 64, 0);
+			if (observedEvents & COMPONENT_UPDATED)
+				updatedBits.assign(changedBits.size(), 0);
+		}
+
+		// flags the entity's component as modified. safe to call from several threads at once
+		void markChanged(entity_t entity)
+		{
+			setBitAtomic(changedBits, entity);
+			if (observedEvents & COMPONENT_UPDATED)
+				setBitAtomic(updatedBits, entity);
+		}
+
+		ObserverID addObserver(ComponentEvent event, ComponentObserver observer)
+		{
+			if (event == COMPONENT_UPDATED && !(observedEvents & COMPONENT_UPDATED))
+				updatedBits.assign(changedBits.size(), 0);
+			observedEvents |= event;
+			observers.push_back({ nextObserverID, event, std::move(observer) });
+			return nextObserverID++;
+		}
+
+		// events keep being queued for the kinds observed so far, they are dropped on flush
+		void removeObserver(ObserverID id)
+		{
+			std::erase_if(observers, [id](const Observer& observer) { return observer.id == id; });
+		}
+
+		// events are only queued for the kinds something listens to
+		bool isObserved() const
+		{
+			return observedEvents != 0;
+		}
+
+		// hands the queued events to the observers: removals first, then additions of entities that
+		// still own the component, then updates of entities that own it. an entity added since the
+		// last flush is reported updated as well, and one removed before it was ever reported added
+		// shows up as removed, so observers have to ignore entities they don't know.
+		// observers may add or remove components, those events are delivered by the next flush
+		void flushEvents()
+		{
+			observedBatch.clear();
+			observedBatch.swap(removedEntities);
+			notify(COMPONENT_REMOVED);
+
+			observedBatch.clear();
+			observedBatch.swap(addedEntities);
+			std::erase_if(observedBatch, [this](entity_t entity) { return !has(entity); });
+			notify(COMPONENT_ADDED);
+
+			observedBatch.clear();
+			for (size_t word = 0; word < updatedBits.size(); word++)
+			{
+				for (uint64_t bits = std::exchange(updatedBits[word], 0); bits; bits &= bits - 1)
+				{
+					const entity_t entity = static_cast<entity_t>(word * 64) + std::countr_zero(bits);
+					if (has(entity))
+						observedBatch.push_back(entity);
+				}
+			}
+			notify(COMPONENT_UPDATED);
+		}
+
+		// queues a removal of every component, for when the whole pool is about to be dropped
+		void queueRemoveAll()
+		{
+			if (observedEvents & COMPONENT_REMOVED)
+				removedEntities.insert(removedEntities.end(), ownerEntities.begin(), ownerEntities.end());
+		}
+
+		// copies the bitset of entities changed since the last call into outBits and clears it.
+		// bits of entities that lost the component since then stay set, check has() when reading
+		void takeChanges(std::vector<uint64_t>& outBits)
+		{
+			outBits.assign(changedBits.begin(), changedBits.end());
+			std::fill(changedBits.begin(), changedBits.end(), 0);
+		}
+
+		// owner of each component, parallel to the dense component array
+		std::vector<entity_t> ownerEntities;
+		// index of each entity's component in the dense arrays, -1 if it doesn't have one
+		std::vector<int32_t> entitiesArray;
+
+	protected:
+		static void setBitAtomic(std::vector<uint64_t>& bitset, entity_t entity)
+		{
+			std::atomic_ref<uint64_t> word(bitset[entity >> 6]);
+			const uint64_t bit = uint64_t(1) << (entity & 63);
+			if (!(word.load(std::memory_order_relaxed) & bit))
+				word.fetch_or(bit, std::memory_order_relaxed);
+		}
+
+		void notify(ComponentEvent event)
+		{
+			if (observedBatch.empty())
+				return;
+			for (const Observer& observer : observers)
+			{
+				if (observer.event == event)
+					observer.function(observedBatch.data(), static_cast<int32_t>(observedBatch.size()));
+			}
+		}
+
+		// one bit per entity, set when its component was added or accessed mutably
+		std::vector<uint64_t> changedBits;
+		uint32_t structureVersion = 0;
+
+		// observer state, events are queued as plain arrays and delivered in batches by flushEvents
+		struct Observer
+		{
+			ObserverID id;
+			ComponentEvent event;
+			ComponentObserver function;
+		};
+		uint32_t observedEvents = 0;
+		ObserverID nextObserverID = 0;
+		std::vector<Observer> observers;
+		std::vector<entity_t> addedEntities;
+		std::vector<entity_t> removedEntities;
+		// same as changedBits, kept separately so takeChanges users and observers don't steal each other's bits
+		std::vector<uint64_t> updatedBits;
+		std::vector<entity_t> observedBatch;
 	};
 
+	// sparse set: components are kept densely packed next to a parallel array of their owners
+	// and removal moves the last component into the hole, so iteration is a linear walk.
+	// components live in pages, so the pool grows without a capacity limit and references
+	// to components stay valid when it grows. removing a component still moves the last one.
 	template<typename ComponentType>
 	class ComponentPool : public ComponentPoolBase
 	{
 	public:
-		ComponentPool(int32_t numOfEntities, int32_t maxComponents) : pool(maxComponents)
+		ComponentPool(int32_t numOfEntities = 0, int32_t initialCapacity = 0)
 		{
-			ownerEntities.reserve(maxComponents);
-			entitiesArray.reserve(numOfEntities);
+			components.reserve(initialCapacity);
+			ownerEntities.reserve(initialCapacity);
+			entitiesArray.resize(numOfEntities, -1);
+			changedBits.resize((numOfEntities + 63) / 64, 0);
 		}
 		ComponentPool(const ComponentPool&) = delete;
 		ComponentPool(ComponentPool&&) = delete;
 
+		void reserve(int32_t count)
+		{
+			components.reserve(count);
+			ownerEntities.reserve(count);
+		}
 
 		ComponentType& add(entity_t entity)
 		{
 			assert(!has(entity) && "entity already have such component.");
-			const int32_t index = pool.add();
-			entitiesArray[entity] = index;
-			ownerEntities.insert(entity);
-			return pool[index];
+			entitiesArray[entity] = components.size();
+			ownerEntities.push_back(entity);
+			structureVersion++;
+			markChanged(entity);
+			if (observedEvents & COMPONENT_ADDED)
+				addedEntities.push_back(entity);
+			return components.emplace_back();
 		}
 
 		void remove(entity_t entity)
 		{
 			assert(has(entity) && "entity don't have such component.");
-			pool.removeAt(entitiesArray[entity]);
-
+			const int32_t index = entitiesArray[entity];
+			const int32_t last = components.size() - 1;
+			if (index != last)
+			{
+				// swap and pop
+				components[index] = std::move(components[last]);
+				ownerEntities[index] = ownerEntities[last];
+				entitiesArray[ownerEntities[index]] = index;
+			}
+			components.pop_back();
+			ownerEntities.pop_back();
 			entitiesArray[entity] = -1;
-			ownerEntities.erase(entity);
+			structureVersion++;
+			if (observedEvents & COMPONENT_REMOVED)
+				removedEntities.push_back(entity);
+		}
+
+		// gives the count consecutive entities starting at first a copy of value, their components
+		// end up next to each other at the end of the dense array
+		void addRange(entity_t first, int32_t count, const ComponentType& value)
+		{
+			const int32_t firstIndex = components.size();
+			components.appendCopies(value, count);
+			ownerEntities.resize(ownerEntities.size() + count);
+			std::iota(ownerEntities.end() - count, ownerEntities.end(), first);
+			structureVersion++;
+			for (int32_t i = 0; i < count; i++)
+			{
+				assert(!has(first + i) && "entity already have such component.");
+				entitiesArray[first + i] = firstIndex + i;
+			}
+			for (entity_t entity = first; entity < first + count; entity++)
+			{
+				changedBits[entity >> 6] |= uint64_t(1) << (entity & 63);
+				if (observedEvents & COMPONENT_UPDATED)
+					updatedBits[entity >> 6] |= uint64_t(1) << (entity & 63);
+			}
+			if (observedEvents & COMPONENT_ADDED)
+				addedEntities.insert(addedEntities.end(), ownerEntities.end() - count, ownerEntities.end());
+		}
+
+		// replaces the pool contents with count components copied from memory, owners[i] owns source[i].
+		// every restored component is flagged as changed and, for observers, removed and added again
+		void assign(const entity_t* owners, const ComponentType* source, int32_t count)
+		{
+			reset();
+			components.append(source, count);
+			ownerEntities.assign(owners, owners + count);
+			structureVersion++;
+			if (observedEvents & COMPONENT_ADDED)
+				addedEntities.insert(addedEntities.end(), owners, owners + count);
+			for (int32_t i = 0; i < count; i++)
+			{
+				const entity_t owner = owners[i];
+				assert(owner >= 0 && owner < static_cast<int32_t>(entitiesArray.size()) && "Component owner is not a valid entity slot.");
+				entitiesArray[owner] = i;
+				changedBits[owner >> 6] |= uint64_t(1) << (owner & 63);
+			}
+		}
+
+		// copies the dense components into a contiguous destination of size() elements
+		void copyTo(ComponentType* destination)
+		{
+			components.copyTo(destination);
 		}
 
 		ComponentType& getOrAdd(entity_t entity)
 		{
 			if (has(entity))
 			{
-				return pool[entitiesArray[entity]];
+				return components[entitiesArray[entity]];
 			}
 			else
 			{
@@ -176,50 +553,161 @@ namespace ve
 		ComponentType& get(entity_t entity)
 		{
 			assert(has(entity) && "entity don't have such component.");
-			return pool[entitiesArray[entity]];
+			return components[entitiesArray[entity]];
 		}
 
-		void reset()
+		// component at a dense index, its owner is ownerEntities[index]
+		ComponentType& at(int32_t index)
 		{
-			pool.reset();
-			std::fill(entitiesArray.begin(), entitiesArray.end(), -1);
-			ownerEntities.clear();
+			return components[index];
 		}
 
-		int32_t size() const
+		void reset()
 		{
-			return pool.num;
+			queueRemoveAll();
+			components.clear();
+			ownerEntities.clear();
+			structureVersion++;
+			std::fill(entitiesArray.begin(), entitiesArray.end(), -1);
+			std::fill(changedBits.begin(), changedBits.end(), 0);
 		}
 
 		int32_t capacity() const
 		{
-			return pool.elements.size();
+			return components.capacity();
 		}
 
 		virtual void removeIfExist(entity_t entity) override
 		{
 			if (has(entity))
 			{
-				entitiesArray[entity] = -1;
-				ownerEntities.erase(entity);
+				remove(entity);
 			}
 		}
 
 		virtual void resetPool() override
 		{
+			// queued additions are gone with the pool, the slots they'd be checked against are dropped too.
+			// removals stay queued and the current owners join them, observers still need to hear of those
+			addedEntities.clear();
+			queueRemoveAll();
+			components.clear();
 			ownerEntities.clear();
+			structureVersion++;
 			entitiesArray.clear();
-			pool.reset();
+			changedBits.clear();
+			updatedBits.clear();
 		}
 
 	public:
-		SimpleSparseArray<ComponentType>::Iterator begin() { return pool.begin(); }
-		SimpleSparseArray<ComponentType>::Iterator end() { return pool.end(); }
+		typename PagedArray<ComponentType>::Iterator begin() { return components.begin(); }
+		typename PagedArray<ComponentType>::Iterator end() { return components.end(); }
+
+	private:
+		PagedArray<ComponentType> components;
+	};
+
+	// iterates the entities that own all of ComponentTypes. iteration is driven by the smallest
+	// pool and membership in the others is tested through their entitiesArray.
+	// dereferencing yields a tuple of (entity, components...), so it can be used as
+	// for (auto [entity, transform, renderer] : manager.view<TransformComponent, RendererComponent>())
+	// request components as const when they are only read, otherwise they get flagged as changed.
+	template<typename... ComponentTypes>
+	class EntityView
+	{
+	public:
+		// signatures is the owner's per entity component bitset, membership is then a single and/compare
+		EntityView(const std::vector<ComponentMask>& inSignatures, ComponentMask inMask, ComponentPool<std::remove_const_t<ComponentTypes>>&... inPools)
+			: pools(&inPools...), signatures(&inSignatures), mask(inMask)
+		{
+			const ComponentPoolBase* driver = nullptr;
+			((driver = (!driver || inPools.size() < driver->size()) ? &inPools : driver), ...);
+			entities = driver->ownerEntities.data();
+			count = driver->size();
+		}
+
+		class Iterator
+		{
+		public:
+			Iterator(const EntityView& inView, int32_t inIndex) : view(inView), index(inIndex)
+			{
+				skipMissing();
+			}
+
+			Iterator& operator++()
+			{
+				++index;
+				skipMissing();
+				return *this;
+			}
+
+			std::tuple<entity_t, ComponentTypes&...> operator*() const
+			{
+				const entity_t entity = view.entities[index];
+				return { entity, view.template component<ComponentTypes>(entity)... };
+			}
+
+			bool operator!=(const Iterator& rhs) const { return index != rhs.index; }
+
+		private:
+			void skipMissing()
+			{
+				while (index < view.count && !view.contains(view.entities[index]))
+					++index;
+			}
+
+			const EntityView& view;
+			int32_t index;
+		};
+
+		bool contains(entity_t entity) const
+		{
+			return ((*signatures)[entity] & mask) == mask;
+		}
+
+		// number of candidates, the size of the smallest pool
+		int32_t size() const
+		{
+			return count;
+		}
+
+		// calls function(entity, components...) for the matching entities among candidates [first, last),
+		// lets a view be split into ranges that are processed on different threads
+		template<typename Function>
+		void each(int32_t first, int32_t last, Function&& function) const
+		{
+			for (int32_t index = first; index < last; index++)
+			{
+				const entity_t entity = entities[index];
+				if (contains(entity))
+					function(entity, component<ComponentTypes>(entity)...);
+			}
+		}
+
+		// non const components are flagged as changed when they are handed out
+		template<typename ComponentType>
+		ComponentType& component(entity_t entity) const
+		{
+			ComponentPool<std::remove_const_t<ComponentType>>* pool = std::get<ComponentPool<std::remove_const_t<ComponentType>>*>(pools);
+			if constexpr (!std::is_const_v<ComponentType>)
+				pool->markChanged(entity);
+			return pool->at(pool->entitiesArray[entity]);
+		}
+
+		Iterator begin() const { return Iterator(*this, 0); }
+		Iterator end() const { return Iterator(*this, count); }
 
 	private:
-		SimpleSparseArray<ComponentType> pool;
+		std::tuple<ComponentPool<std::remove_const_t<ComponentTypes>>*...> pools;
+		const std::vector<ComponentMask>* signatures;
+		ComponentMask mask;
+		const entity_t* entities;
+		int32_t count;
 	};
 
+	template<typename Manager>
+	class BasicPrefab;
+
 	class EntityManager
 	{
 	public:
@@ -237,17 +725,20 @@ namespace ve
 			}
 		}
 
+		// pools grow on demand, initialCapacity only reserves pages up front
 		template<typename ComponentType>
-		void registerComponent(int32_t maxCapacity)
+		void registerComponent(int32_t initialCapacity = 0)
 		{
 			const int32_t componentTypeID = ComponentTypeSquence<ComponentType>::value();
 			assert(pools.size() == componentTypeID && "Error in component registration.");
-			pools.push_back(std::make_shared<ComponentPool<ComponentType>>(static_cast<int32_t>(entities.size()), maxCapacity));
+			assert(componentTypeID < 64 && "Component signatures are 64 bit wide.");
+			pools.push_back(std::make_shared<ComponentPool<ComponentType>>(static_cast<int32_t>(entities.size()), initialCapacity));
 		}
 
 		void reserveEntities(int32_t inExpectedNumOfEntities)
 		{
 			entities.reserve(inExpectedNumOfEntities);
+			signatures.reserve(inExpectedNumOfEntities);
 		}
 
 		entity_t createEntity()
@@ -262,21 +753,54 @@ namespace ve
 			{
 				const entity_t newEntity = entities.size();
 				entities.push_back(newEntity);
+				signatures.push_back(0);
 				for (auto pool : pools)
 				{
-					pool->entitiesArray.push_back(-1);
+					pool->addEntitySlot();
 				}
 				return newEntity;
 			}
 		}
 
+		// creates count entities with consecutive ids in one pass and returns the first one.
+		// free slots of destroyed entities are not reused, so the ids stay contiguous
+		entity_t createEntities(int32_t count)
+		{
+			const entity_t first = entities.size();
+			entities.resize(first + count);
+			std::iota(entities.begin() + first, entities.end(), first);
+			signatures.resize(first + count, 0);
+			for (auto pool : pools)
+			{
+				pool->addEntitySlots(count);
+			}
+			return first;
+		}
+
+		// creates count entities with the prefab's components. the returned ids point into the entity
+		// table and stay valid until the next entity is created
+		std::span<const entity_t> instantiate(const BasicPrefab<EntityManager>& prefab, int32_t count);
+
+		// gives the count entities starting at first a copy of value each
+		template<typename ComponentType>
+		void addComponents(entity_t first, int32_t count, const ComponentType& value)
+		{
+			const ComponentMask mask = getComponentMask<ComponentType>();
+			for (entity_t entity = first; entity < first + count; entity++)
+				signatures[entity] |= mask;
+			getPool<ComponentType>().addRange(first, count, value);
+		}
+
 		void destroyEntity(entity_t entity)
 		{
 			assert(isValid(entity) && "Entity id is not valid.");
+			if (destroyHook)
+				destroyHook(entity);
 			for (auto pool : pools)
 			{
 				pool->removeIfExist(entity);
 			}
+			signatures[entity] = 0;
 			entities[entity] = availableEntity;
 			availableEntity = entity;
 		}
@@ -287,49 +811,150 @@ namespace ve
 			size_t cap = entities.capacity();
 			entities.clear();
 			entities.reserve(cap);
+			signatures.clear();
+			for (auto pool : pools)
+			{
+				pool->resetPool();
+			}
+		}
+
+		// replaces every entity with a saved entity table, free slots keep their free list links.
+		// all pools are emptied, restore their contents with restoreComponents afterwards
+		void restoreEntities(const entity_t* inEntities, int32_t count, entity_t inAvailableEntity)
+		{
+			availableEntity = inAvailableEntity;
+			entities.assign(inEntities, inEntities + count);
+			signatures.assign(count, 0);
 			for (auto pool : pools)
 			{
 				pool->resetPool();
+				pool->resizeEntitySlots(count);
 			}
 		}
 
+		template<typename ComponentType>
+		void restoreComponents(const entity_t* owners, const ComponentType* source, int32_t count)
+		{
+			getPool<ComponentType>().assign(owners, source, count);
+			const ComponentMask mask = getComponentMask<ComponentType>();
+			for (int32_t i = 0; i < count; i++)
+				signatures[owners[i]] |= mask;
+		}
+
+		// raw entity slots, a slot holds its own id when alive and the next free slot otherwise
+		const std::vector<entity_t>& getEntityTable() const
+		{
+			return entities;
+		}
+
+		// head of the free slot list, -1 when empty
+		entity_t getAvailableEntity() const
+		{
+			return availableEntity;
+		}
+
 		template<typename ComponentType>
 		ComponentType& AddComponent(entity_t entity)
 		{
+			signatures[entity] |= getComponentMask<ComponentType>();
 			return getPool<ComponentType>().add(entity);
 		}
 
 		template<typename ComponentType>
 		void RemoveComponent(entity_t entity)
 		{
-			return getPool<ComponentType>().remove(entity);
+			getPool<ComponentType>().remove(entity);
+			signatures[entity] &= ~getComponentMask<ComponentType>();
 		}
 
 		template<typename ComponentType>
 		bool HasComponent(entity_t entity) const
 		{
-			return const_cast<EntityManager*>(this)->getPool<ComponentType>().has(entity);
+			return (signatures[entity] & getComponentMask<ComponentType>()) != 0;
+		}
+
+		template<typename... ComponentTypes>
+		bool HasComponents(entity_t entity) const
+		{
+			return matches(entity, getComponentMask<ComponentTypes...>());
+		}
+
+		bool matches(entity_t entity, ComponentMask mask) const
+		{
+			return (signatures[entity] & mask) == mask;
 		}
 
+		// bit i is set when the entity owns the component with static id i
+		ComponentMask getSignature(entity_t entity) const
+		{
+			return signatures[entity];
+		}
+
+		// every live entity that has all components in mask
+		void filterEntities(ComponentMask mask, std::vector<entity_t>& outEntities) const
+		{
+			outEntities.clear();
+			filterSignatures(signatures.data(), static_cast<int32_t>(signatures.size()), mask, outEntities);
+		}
+
+		// mutable access flags the component as changed, use ReadComponent when only reading
 		template<typename ComponentType>
 		ComponentType& GetComponent(entity_t entity)
+		{
+			ComponentPool<ComponentType>& pool = getPool<ComponentType>();
+			pool.markChanged(entity);
+			return pool.get(entity);
+		}
+
+		template<typename ComponentType>
+		const ComponentType& ReadComponent(entity_t entity)
 		{
 			return getPool<ComponentType>().get(entity);
 		}
 
-		void GetComponentIDs(entity_t entity, std::unordered_set<int32_t>& outComponentsID)
+		template<typename ComponentType>
+		void takeChanges(std::vector<uint64_t>& outBits)
+		{
+			getPool<ComponentType>().takeChanges(outBits);
+		}
+
+		// observer is called with the entities that got event on ComponentType, batched until flushObservers
+		template<typename ComponentType>
+		ObserverID observe(ComponentEvent event, ComponentObserver observer)
+		{
+			return getPool<ComponentType>().addObserver(event, std::move(observer));
+		}
+
+		template<typename ComponentType>
+		void removeObserver(ObserverID id)
 		{
-			outComponentsID.clear();
+			getPool<ComponentType>().removeObserver(id);
+		}
 
-			int32_t poolIndex = 0;
+		// for owners of links between entities, which have to be cleaned up however an entity is
+		// destroyed, the command buffer included. the hook may destroy other entities
+		void setDestroyHook(DestroyHook hook)
+		{
+			destroyHook = std::move(hook);
+		}
+
+		// delivers the events queued since the last call, pool by pool. call it from one thread
+		// at a point where no system is running, like the start of a frame
+		void flushObservers()
+		{
 			for (auto pool : pools)
 			{
-				if (pool->has(entity))
-					outComponentsID.insert(poolIndex);
-				poolIndex++;
+				if (pool->isObserved())
+					pool->flushEvents();
 			}
 		}
 
+		template<typename... ComponentTypes>
+		EntityView<ComponentTypes...> view()
+		{
+			return EntityView<ComponentTypes...>(signatures, getComponentMask<ComponentTypes...>(), getPool<std::remove_const_t<ComponentTypes>>()...);
+		}
+
 		bool isValid(entity_t entity)
 		{
 			return entity < entities.size() && entities[entity] == entity;
@@ -342,11 +967,25 @@ namespace ve
 		}
 
 		template<typename ComponentType>
-		std::unordered_set<entity_t>& getEntities()
+		const std::vector<entity_t>& getEntities()
 		{
 			return pools[ComponentTypeSquence<ComponentType>::value()]->ownerEntities;
 		}
 
+		// bumped whenever the component is added to or removed from an entity
+		template<typename ComponentType>
+		uint32_t getStructureVersion()
+		{
+			return getPool<ComponentType>().getStructureVersion();
+		}
+
+		// copies the components into destination in the order of getEntities
+		template<typename ComponentType>
+		void copyComponents(ComponentType* destination)
+		{
+			getPool<ComponentType>().copyTo(destination);
+		}
+
 		template<typename ComponentType>
 		static int32_t getComponentStaticID()
 		{
@@ -376,6 +1015,45 @@ namespace ve
 	private:
 		entity_t availableEntity;
 		std::vector<entity_t> entities;
+		std::vector<ComponentMask> signatures;
 		std::vector<std::shared_ptr<ComponentPoolBase>> pools;
+		DestroyHook destroyHook;
 	};
+
+	// a set of components with default values, instantiated in bulk by Manager::instantiate
+	template<typename Manager>
+	class BasicPrefab
+	{
+	public:
+		template<typename ComponentType>
+		BasicPrefab& add(const ComponentType& value = ComponentType{})
+		{
+			mask |= getComponentMask<ComponentType>();
+			spawners.push_back([value](Manager& manager, entity_t first, int32_t count)
+				{
+					manager.template addComponents<ComponentType>(first, count, value);
+				});
+			return *this;
+		}
+
+		ComponentMask getMask() const
+		{
+			return mask;
+		}
+
+	private:
+		friend Manager;
+		ComponentMask mask = 0;
+		std::vector<std::function<void(Manager&, entity_t, int32_t)>> spawners;
+	};
+
+	typedef BasicPrefab<EntityManager> Prefab;
+
+	inline std::span<const entity_t> EntityManager::instantiate(const Prefab& prefab, int32_t count)
+	{
+		const entity_t first = createEntities(count);
+		for (const auto& spawn : prefab.spawners)
+			spawn(*this, first, count);
+		return std::span<const entity_t>(entities.data() + first, count);
+	}
 }
\ No newline at end of file
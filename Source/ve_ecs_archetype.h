@@ -0,0 +1,987 @@
+#pragma once
+
+#include "ve_ecs.h"
+
+// std
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <numeric>
+#include <span>
+#include <unordered_map>
+
+namespace ve
+{
+	// alternative to EntityManager that groups entities with the same set of components into
+	// archetypes. every archetype stores its entities in fixed size chunks with one column per
+	// component (SoA), so iterating a set of components only touches contiguous chunk memory.
+	// it exposes the same template API as EntityManager so the two backends can be swapped.
+	typedef uint64_t ArchetypeSignature;
+
+	struct ComponentTypeInfo
+	{
+		size_t size = 0;
+		size_t alignment = 1;
+		void (*construct)(void* dst) = nullptr;
+		void (*moveConstruct)(void* dst, void* src) = nullptr;
+		void (*destroy)(void* ptr) = nullptr;
+
+		template<typename ComponentType>
+		static ComponentTypeInfo create()
+		{
+			ComponentTypeInfo info;
+			info.size = sizeof(ComponentType);
+			info.alignment = alignof(ComponentType);
+			info.construct = [](void* dst) { new (dst) ComponentType(); };
+			info.moveConstruct = [](void* dst, void* src) { new (dst) ComponentType(std::move(*static_cast<ComponentType*>(src))); };
+			info.destroy = [](void* ptr) { static_cast<ComponentType*>(ptr)->~ComponentType(); };
+			return info;
+		}
+	};
+
+	// change bits and observers of one component type, with the same semantics as the ones of ComponentPool
+	struct ArchetypeComponentState
+	{
+		struct Observer
+		{
+			ObserverID id;
+			ComponentEvent event;
+			ComponentObserver function;
+		};
+
+		// flags the entity's component as modified. safe to call from several threads at once
+		void markChanged(entity_t entity)
+		{
+			setBitAtomic(changedBits, entity);
+			if (observedEvents & COMPONENT_UPDATED)
+				setBitAtomic(updatedBits, entity);
+		}
+
+		void resizeEntitySlots(int32_t numOfEntities)
+		{
+			changedBits.resize((numOfEntities + 63) / 64, 0);
+			if (observedEvents & COMPONENT_UPDATED)
+				updatedBits.resize(changedBits.size(), 0);
+		}
+
+		void notify(ComponentEvent event)
+		{
+			if (observedBatch.empty())
+				return;
+			for (const Observer& observer : observers)
+			{
+				if (observer.event == event)
+					observer.function(observedBatch.data(), static_cast<int32_t>(observedBatch.size()));
+			}
+		}
+
+		static void setBitAtomic(std::vector<uint64_t>& bitset, entity_t entity)
+		{
+			std::atomic_ref<uint64_t> word(bitset[entity >> 6]);
+			const uint64_t bit = uint64_t(1) << (entity & 63);
+			if (!(word.load(std::memory_order_relaxed) & bit))
+				word.fetch_or(bit, std::memory_order_relaxed);
+		}
+
+		// chunks an archetype with this component reserves up front are sized for initialCapacity entities
+		int32_t initialCapacity = 0;
+		// bumped whenever the component is added to or removed from an entity, like ComponentPool's
+		uint32_t structureVersion = 0;
+		std::vector<uint64_t> changedBits;
+		std::vector<uint64_t> updatedBits;
+		uint32_t observedEvents = 0;
+		ObserverID nextObserverID = 0;
+		std::vector<Observer> observers;
+		std::vector<entity_t> addedEntities;
+		std::vector<entity_t> removedEntities;
+		std::vector<entity_t> observedBatch;
+		// filled by getEntities
+		std::vector<entity_t> owners;
+	};
+
+	class Archetype
+	{
+	public:
+		static constexpr size_t CHUNK_SIZE = 16 * 1024;
+		static constexpr int32_t MAX_COMPONENTS = 64;
+
+		struct Chunk
+		{
+			alignas(64) std::byte data[CHUNK_SIZE];
+			int32_t count = 0;
+		};
+
+		Archetype(ArchetypeSignature inSignature, const std::vector<ComponentTypeInfo>& typeInfos)
+			: signature(inSignature)
+		{
+			columnOffsets.fill(-1);
+			addEdges.fill(nullptr);
+			removeEdges.fill(nullptr);
+
+			size_t rowSize = sizeof(entity_t);
+			for (int32_t componentID = 0; componentID < MAX_COMPONENTS; componentID++)
+			{
+				if (signature & (ArchetypeSignature(1) << componentID))
+				{
+					componentIDs.push_back(componentID);
+					columnTypes.push_back(&typeInfos[componentID]);
+					rowSize += typeInfos[componentID].size;
+				}
+			}
+
+			// start from the unpadded estimate and shrink until the aligned columns fit
+			chunkCapacity = static_cast<int32_t>(CHUNK_SIZE / rowSize);
+			assert(chunkCapacity > 0 && "Components are too big to fit in an archetype chunk.");
+			while (!layoutColumns(chunkCapacity))
+				chunkCapacity--;
+		}
+
+		~Archetype()
+		{
+			for (std::unique_ptr<Chunk>& chunk : chunks)
+			{
+				for (size_t column = 0; column < componentIDs.size(); column++)
+				{
+					for (int32_t row = 0; row < chunk->count; row++)
+						columnTypes[column]->destroy(componentAt(*chunk, column, row));
+				}
+			}
+		}
+
+		Archetype(const Archetype&) = delete;
+		Archetype& operator=(const Archetype&) = delete;
+
+		bool hasComponent(int32_t componentID) const
+		{
+			return signature & (ArchetypeSignature(1) << componentID);
+		}
+
+		entity_t* entities(Chunk& chunk)
+		{
+			return reinterpret_cast<entity_t*>(chunk.data);
+		}
+
+		template<typename ComponentType>
+		ComponentType* column(Chunk& chunk, int32_t componentID)
+		{
+			return reinterpret_cast<ComponentType*>(chunk.data + columnOffsets[componentID]);
+		}
+
+		void* componentAt(Chunk& chunk, size_t column, int32_t row)
+		{
+			return chunk.data + columnOffsets[componentIDs[column]] + row * columnTypes[column]->size;
+		}
+
+		// appends a row for entity without constructing its components, every chunk but the last is always full
+		void allocateRow(entity_t entity, int32_t& outChunk, int32_t& outRow)
+		{
+			if (chunks.empty() || chunks.back()->count == chunkCapacity)
+				chunks.push_back(std::unique_ptr<Chunk>(new Chunk));
+
+			Chunk& chunk = *chunks.back();
+			outChunk = static_cast<int32_t>(chunks.size()) - 1;
+			outRow = chunk.count++;
+			entities(chunk)[outRow] = entity;
+		}
+
+		// destroys the components of a row and moves the last row of the archetype into the hole.
+		// returns the entity that was moved, or -1 if the removed row was the last one
+		entity_t removeRow(int32_t chunkIndex, int32_t row)
+		{
+			Chunk& chunk = *chunks[chunkIndex];
+			Chunk& lastChunk = *chunks.back();
+			const int32_t lastRow = lastChunk.count - 1;
+			const bool isLast = &chunk == &lastChunk && row == lastRow;
+
+			for (size_t column = 0; column < componentIDs.size(); column++)
+			{
+				void* component = componentAt(chunk, column, row);
+				columnTypes[column]->destroy(component);
+				if (!isLast)
+				{
+					void* lastComponent = componentAt(lastChunk, column, lastRow);
+					columnTypes[column]->moveConstruct(component, lastComponent);
+					columnTypes[column]->destroy(lastComponent);
+				}
+			}
+
+			entity_t movedEntity = -1;
+			if (!isLast)
+			{
+				movedEntity = entities(lastChunk)[lastRow];
+				entities(chunk)[row] = movedEntity;
+			}
+
+			if (--lastChunk.count == 0)
+				chunks.pop_back();
+
+			return movedEntity;
+		}
+
+		int32_t size() const
+		{
+			return chunks.empty() ? 0 : static_cast<int32_t>(chunks.size() - 1) * chunkCapacity + chunks.back()->count;
+		}
+
+		const ArchetypeSignature signature;
+		std::vector<int32_t> componentIDs;
+		std::vector<const ComponentTypeInfo*> columnTypes;
+		std::vector<std::unique_ptr<Chunk>> chunks;
+		int32_t chunkCapacity;
+
+		// cached archetype transitions for adding or removing a component
+		std::array<Archetype*, MAX_COMPONENTS> addEdges;
+		std::array<Archetype*, MAX_COMPONENTS> removeEdges;
+
+	private:
+		bool layoutColumns(int32_t capacity)
+		{
+			size_t offset = sizeof(entity_t) * capacity;
+			for (size_t column = 0; column < componentIDs.size(); column++)
+			{
+				const size_t alignment = columnTypes[column]->alignment;
+				offset = (offset + alignment - 1) & ~(alignment - 1);
+				columnOffsets[componentIDs[column]] = static_cast<int32_t>(offset);
+				offset += columnTypes[column]->size * capacity;
+			}
+			return offset <= CHUNK_SIZE;
+		}
+
+		std::array<int32_t, MAX_COMPONENTS> columnOffsets;
+	};
+
+	// dereferencing flags the components requested as non const as changed, like EntityView
+	template<typename... ComponentTypes>
+	class ArchetypeView
+	{
+	public:
+		ArchetypeView(std::vector<Archetype*>&& inArchetypes, std::array<ArchetypeComponentState*, sizeof...(ComponentTypes)> inStates)
+			: archetypes(std::move(inArchetypes)), states(inStates) {}
+
+		class Iterator
+		{
+		public:
+			Iterator(const ArchetypeView& inView, size_t inArchetype) : view(inView), archetype(inArchetype)
+			{
+				chunk = 0;
+				row = 0;
+				loadChunk();
+			}
+
+			Iterator& operator++()
+			{
+				if (++row == rowCount)
+				{
+					chunk++;
+					row = 0;
+					loadChunk();
+				}
+				return *this;
+			}
+
+			std::tuple<entity_t, ComponentTypes&...> operator*() const
+			{
+				for (ArchetypeComponentState* state : view.states)
+				{
+					if (state)
+						state->markChanged(entities[row]);
+				}
+				return { entities[row], std::get<ComponentTypes*>(columns)[row]... };
+			}
+
+			bool operator!=(const Iterator& rhs) const { return archetype != rhs.archetype || chunk != rhs.chunk || row != rhs.row; }
+
+		private:
+			// points the iterator at the first non empty chunk at or after the current one
+			void loadChunk()
+			{
+				for (; archetype < view.archetypes.size(); archetype++, chunk = 0)
+				{
+					Archetype& current = *view.archetypes[archetype];
+					if (chunk < current.chunks.size())
+					{
+						Archetype::Chunk& currentChunk = *current.chunks[chunk];
+						entities = current.entities(currentChunk);
+						columns = { current.column<ComponentTypes>(currentChunk, ComponentTypeSquence<std::remove_const_t<ComponentTypes>>::value())... };
+						rowCount = currentChunk.count;
+						return;
+					}
+				}
+				chunk = 0;
+			}
+
+			const ArchetypeView& view;
+			size_t archetype;
+			size_t chunk;
+			int32_t row;
+			int32_t rowCount = 0;
+			entity_t* entities = nullptr;
+			std::tuple<ComponentTypes*...> columns;
+		};
+
+		// calls function(entityCount, entities, columns...) once per chunk, for loops that want raw arrays
+		template<typename Function>
+		void eachChunk(Function&& function) const
+		{
+			for (Archetype* archetype : archetypes)
+			{
+				for (std::unique_ptr<Archetype::Chunk>& chunk : archetype->chunks)
+				{
+					for (ArchetypeComponentState* state : states)
+					{
+						for (int32_t row = 0; state && row < chunk->count; row++)
+							state->markChanged(archetype->entities(*chunk)[row]);
+					}
+					function(chunk->count, archetype->entities(*chunk),
+						archetype->column<ComponentTypes>(*chunk, ComponentTypeSquence<std::remove_const_t<ComponentTypes>>::value())...);
+				}
+			}
+		}
+
+		// number of entities in the matching archetypes, unlike EntityView every one of them matches
+		int32_t size() const
+		{
+			int32_t count = 0;
+			for (Archetype* archetype : archetypes)
+				count += archetype->size();
+			return count;
+		}
+
+		// calls function(entity, components...) for the entities [first, last) in iteration order,
+		// lets a view be split into ranges that are processed on different threads like EntityView::each
+		template<typename Function>
+		void each(int32_t first, int32_t last, Function&& function) const
+		{
+			int32_t base = 0;
+			for (Archetype* archetype : archetypes)
+			{
+				for (std::unique_ptr<Archetype::Chunk>& chunk : archetype->chunks)
+				{
+					const int32_t begin = std::max(first - base, 0);
+					const int32_t end = std::min(last - base, chunk->count);
+					base += chunk->count;
+					if (begin >= end)
+						continue;
+
+					entity_t* entities = archetype->entities(*chunk);
+					const std::tuple<ComponentTypes*...> columns{
+						archetype->column<ComponentTypes>(*chunk, ComponentTypeSquence<std::remove_const_t<ComponentTypes>>::value())... };
+					for (int32_t row = begin; row < end; row++)
+					{
+						for (ArchetypeComponentState* state : states)
+						{
+							if (state)
+								state->markChanged(entities[row]);
+						}
+						function(entities[row], std::get<ComponentTypes*>(columns)[row]...);
+					}
+					if (base >= last)
+						return;
+				}
+			}
+		}
+
+		Iterator begin() const { return Iterator(*this, 0); }
+		Iterator end() const { return Iterator(*this, archetypes.size()); }
+
+	private:
+		std::vector<Archetype*> archetypes;
+		// change state of each non const component type, nullptr for the const ones
+		std::array<ArchetypeComponentState*, sizeof...(ComponentTypes)> states;
+	};
+
+	class ArchetypeEntityManager
+	{
+	public:
+		ArchetypeEntityManager(int32_t inExpectedNumOfEntities = 100)
+			: availableEntity(-1)
+		{
+			reserveEntities(inExpectedNumOfEntities);
+		}
+
+		ArchetypeEntityManager(const ArchetypeEntityManager&) = delete;
+		ArchetypeEntityManager& operator=(const ArchetypeEntityManager&) = delete;
+
+		// archetype chunks grow on demand, archetypes with this component reserve the chunk list
+		// for initialCapacity entities when they are created
+		template<typename ComponentType>
+		void registerComponent(int32_t initialCapacity = 0)
+		{
+			const int32_t componentTypeID = ComponentTypeSquence<ComponentType>::value();
+			assert(componentTypeID < Archetype::MAX_COMPONENTS && "Too many component types for an archetype signature.");
+			if (componentTypeID >= static_cast<int32_t>(typeInfos.size()))
+			{
+				// archetypes keep pointers into typeInfos so it can only grow before the first one is created
+				assert(archetypes.empty() && "Components must be registered before creating entities.");
+				typeInfos.resize(componentTypeID + 1);
+				states.resize(componentTypeID + 1);
+			}
+			typeInfos[componentTypeID] = ComponentTypeInfo::create<ComponentType>();
+			states[componentTypeID].initialCapacity = initialCapacity;
+			states[componentTypeID].resizeEntitySlots(capacity());
+		}
+
+		void reserveEntities(int32_t inExpectedNumOfEntities)
+		{
+			entities.reserve(inExpectedNumOfEntities);
+			locations.reserve(inExpectedNumOfEntities);
+		}
+
+		entity_t createEntity()
+		{
+			entity_t entity;
+			if (availableEntity != -1)
+			{
+				entity = availableEntity;
+				availableEntity = entities[entity];
+				entities[entity] = entity;
+			}
+			else
+			{
+				entity = static_cast<entity_t>(entities.size());
+				entities.push_back(entity);
+				locations.emplace_back();
+				if ((entity & 63) == 0)
+				{
+					for (ArchetypeComponentState& state : states)
+						state.resizeEntitySlots(capacity());
+				}
+			}
+
+			EntityLocation& location = locations[entity];
+			location.archetype = getOrCreateArchetype(0);
+			location.archetype->allocateRow(entity, location.chunk, location.row);
+			return entity;
+		}
+
+		// see EntityManager::createEntities
+		entity_t createEntities(int32_t count)
+		{
+			return appendEntities(count, getOrCreateArchetype(0));
+		}
+
+		// the entities are created in the archetype of the prefab's components, so adding
+		// them doesn't move the entities again. see EntityManager::instantiate
+		std::span<const entity_t> instantiate(const BasicPrefab<ArchetypeEntityManager>& prefab, int32_t count)
+		{
+			const entity_t first = appendEntities(count, getOrCreateArchetype(prefab.getMask()));
+			for (const auto& spawn : prefab.spawners)
+				spawn(*this, first, count);
+			return std::span<const entity_t>(entities.data() + first, count);
+		}
+
+		// gives the count entities starting at first a copy of value each, entities that already
+		// have the component, like the ones of instantiate, only get the value assigned
+		template<typename ComponentType>
+		void addComponents(entity_t first, int32_t count, const ComponentType& value)
+		{
+			for (entity_t entity = first; entity < first + count; entity++)
+			{
+				if (!HasComponent<ComponentType>(entity))
+					AddComponent<ComponentType>(entity);
+				GetComponent<ComponentType>(entity) = value;
+			}
+		}
+
+		void destroyEntity(entity_t entity)
+		{
+			assert(isValid(entity) && "Entity id is not valid.");
+			if (destroyHook)
+				destroyHook(entity);
+			EntityLocation& location = locations[entity];
+			for (int32_t componentID : location.archetype->componentIDs)
+			{
+				states[componentID].structureVersion++;
+				if (states[componentID].observedEvents & COMPONENT_REMOVED)
+					states[componentID].removedEntities.push_back(entity);
+			}
+			fixMovedEntity(location, location.archetype->removeRow(location.chunk, location.row));
+			location.archetype = nullptr;
+			entities[entity] = availableEntity;
+			availableEntity = entity;
+		}
+
+		void reset()
+		{
+			// every component is removed, queued additions refer to entity slots that are gone
+			for (std::unique_ptr<Archetype>& archetype : archetypes)
+			{
+				for (int32_t componentID : archetype->componentIDs)
+				{
+					ArchetypeComponentState& state = states[componentID];
+					if (!(state.observedEvents & COMPONENT_REMOVED))
+						continue;
+					for (std::unique_ptr<Archetype::Chunk>& chunk : archetype->chunks)
+						state.removedEntities.insert(state.removedEntities.end(), archetype->entities(*chunk), archetype->entities(*chunk) + chunk->count);
+				}
+			}
+			for (ArchetypeComponentState& state : states)
+			{
+				state.structureVersion++;
+				state.addedEntities.clear();
+				state.changedBits.clear();
+				state.updatedBits.clear();
+			}
+
+			availableEntity = -1;
+			entities.clear();
+			locations.clear();
+			archetypeMap.clear();
+			archetypes.clear();
+		}
+
+		// see EntityManager::restoreEntities, the live entities start out without components
+		void restoreEntities(const entity_t* inEntities, int32_t count, entity_t inAvailableEntity)
+		{
+			reset();
+			availableEntity = inAvailableEntity;
+			entities.assign(inEntities, inEntities + count);
+			locations.assign(count, EntityLocation{});
+			for (ArchetypeComponentState& state : states)
+				state.resizeEntitySlots(count);
+
+			Archetype* empty = getOrCreateArchetype(0);
+			for (entity_t entity = 0; entity < count; entity++)
+			{
+				if (entities[entity] == entity)
+				{
+					locations[entity].archetype = empty;
+					empty->allocateRow(entity, locations[entity].chunk, locations[entity].row);
+				}
+			}
+		}
+
+		// every owner moves to the archetype with the component one at a time, unlike the sparse
+		// pools this isn't a bulk copy
+		template<typename ComponentType>
+		void restoreComponents(const entity_t* owners, const ComponentType* source, int32_t count)
+		{
+			for (int32_t i = 0; i < count; i++)
+				AddComponent<ComponentType>(owners[i]) = source[i];
+		}
+
+		// see EntityManager::getEntityTable
+		const std::vector<entity_t>& getEntityTable() const
+		{
+			return entities;
+		}
+
+		entity_t getAvailableEntity() const
+		{
+			return availableEntity;
+		}
+
+		template<typename ComponentType>
+		ComponentType& AddComponent(entity_t entity)
+		{
+			assert(!HasComponent<ComponentType>(entity) && "entity already have such component.");
+			const int32_t componentTypeID = ComponentTypeSquence<ComponentType>::value();
+			Archetype* source = locations[entity].archetype;
+			Archetype*& destination = source->addEdges[componentTypeID];
+			if (!destination)
+				destination = getOrCreateArchetype(source->signature | (ArchetypeSignature(1) << componentTypeID));
+
+			moveEntity(entity, destination);
+			ArchetypeComponentState& state = states[componentTypeID];
+			state.structureVersion++;
+			if (state.observedEvents & COMPONENT_ADDED)
+				state.addedEntities.push_back(entity);
+			return GetComponent<ComponentType>(entity);
+		}
+
+		template<typename ComponentType>
+		void RemoveComponent(entity_t entity)
+		{
+			assert(HasComponent<ComponentType>(entity) && "entity don't have such component.");
+			const int32_t componentTypeID = ComponentTypeSquence<ComponentType>::value();
+			Archetype* source = locations[entity].archetype;
+			Archetype*& destination = source->removeEdges[componentTypeID];
+			if (!destination)
+				destination = getOrCreateArchetype(source->signature & ~(ArchetypeSignature(1) << componentTypeID));
+
+			moveEntity(entity, destination);
+			ArchetypeComponentState& state = states[componentTypeID];
+			state.structureVersion++;
+			if (state.observedEvents & COMPONENT_REMOVED)
+				state.removedEntities.push_back(entity);
+		}
+
+		// a destroyed entity has no archetype and no components
+		template<typename ComponentType>
+		bool HasComponent(entity_t entity) const
+		{
+			const Archetype* archetype = locations[entity].archetype;
+			return archetype && archetype->hasComponent(ComponentTypeSquence<ComponentType>::value());
+		}
+
+		template<typename... ComponentTypes>
+		bool HasComponents(entity_t entity) const
+		{
+			return matches(entity, getComponentMask<ComponentTypes...>());
+		}
+
+		bool matches(entity_t entity, ComponentMask mask) const
+		{
+			return (getSignature(entity) & mask) == mask;
+		}
+
+		// the archetype signature, it uses the same bits as EntityManager's signatures
+		ComponentMask getSignature(entity_t entity) const
+		{
+			const Archetype* archetype = locations[entity].archetype;
+			return archetype ? archetype->signature : 0;
+		}
+
+		// every live entity that has all components in mask, in archetype order instead of by id
+		void filterEntities(ComponentMask mask, std::vector<entity_t>& outEntities) const
+		{
+			outEntities.clear();
+			for (const std::unique_ptr<Archetype>& archetype : archetypes)
+			{
+				if ((archetype->signature & mask) != mask)
+					continue;
+				for (std::unique_ptr<Archetype::Chunk>& chunk : archetype->chunks)
+					outEntities.insert(outEntities.end(), archetype->entities(*chunk), archetype->entities(*chunk) + chunk->count);
+			}
+		}
+
+		// mutable access flags the component as changed, use ReadComponent when only reading
+		template<typename ComponentType>
+		ComponentType& GetComponent(entity_t entity)
+		{
+			states[ComponentTypeSquence<ComponentType>::value()].markChanged(entity);
+			return componentOf<ComponentType>(entity);
+		}
+
+		template<typename ComponentType>
+		const ComponentType& ReadComponent(entity_t entity)
+		{
+			return componentOf<ComponentType>(entity);
+		}
+
+		template<typename ComponentType>
+		void takeChanges(std::vector<uint64_t>& outBits)
+		{
+			std::vector<uint64_t>& changedBits = states[ComponentTypeSquence<ComponentType>::value()].changedBits;
+			outBits.assign(changedBits.begin(), changedBits.end());
+			std::fill(changedBits.begin(), changedBits.end(), 0);
+		}
+
+		// observer is called with the entities that got event on ComponentType, batched until flushObservers
+		template<typename ComponentType>
+		ObserverID observe(ComponentEvent event, ComponentObserver observer)
+		{
+			ArchetypeComponentState& state = states[ComponentTypeSquence<ComponentType>::value()];
+			if (event == COMPONENT_UPDATED && !(state.observedEvents & COMPONENT_UPDATED))
+				state.updatedBits.assign(state.changedBits.size(), 0);
+			state.observedEvents |= event;
+			state.observers.push_back({ state.nextObserverID, event, std::move(observer) });
+			return state.nextObserverID++;
+		}
+
+		template<typename ComponentType>
+		void removeObserver(ObserverID id)
+		{
+			std::erase_if(states[ComponentTypeSquence<ComponentType>::value()].observers,
+				[id](const ArchetypeComponentState::Observer& observer) { return observer.id == id; });
+		}
+
+		// see EntityManager::setDestroyHook
+		void setDestroyHook(DestroyHook hook)
+		{
+			destroyHook = std::move(hook);
+		}
+
+		// delivers the events queued since the last call in the same order as EntityManager::flushObservers
+		void flushObservers()
+		{
+			for (int32_t componentID = 0; componentID < static_cast<int32_t>(states.size()); componentID++)
+			{
+				ArchetypeComponentState& state = states[componentID];
+				if (state.observedEvents == 0)
+					continue;
+				auto owns = [this, componentID](entity_t entity)
+					{
+						return entity < capacity() && locations[entity].archetype && locations[entity].archetype->hasComponent(componentID);
+					};
+
+				state.observedBatch.clear();
+				state.observedBatch.swap(state.removedEntities);
+				state.notify(COMPONENT_REMOVED);
+
+				state.observedBatch.clear();
+				state.observedBatch.swap(state.addedEntities);
+				std::erase_if(state.observedBatch, [&owns](entity_t entity) { return !owns(entity); });
+				state.notify(COMPONENT_ADDED);
+
+				state.observedBatch.clear();
+				for (size_t word = 0; word < state.updatedBits.size(); word++)
+				{
+					for (uint64_t bits = std::exchange(state.updatedBits[word], 0); bits; bits &= bits - 1)
+					{
+						const entity_t entity = static_cast<entity_t>(word * 64) + std::countr_zero(bits);
+						if (owns(entity))
+							state.observedBatch.push_back(entity);
+					}
+				}
+				state.notify(COMPONENT_UPDATED);
+			}
+		}
+
+		template<typename... ComponentTypes>
+		ArchetypeView<ComponentTypes...> view()
+		{
+			const ArchetypeSignature mask = ((ArchetypeSignature(1) << ComponentTypeSquence<std::remove_const_t<ComponentTypes>>::value()) | ...);
+			std::vector<Archetype*> matching;
+			for (std::unique_ptr<Archetype>& archetype : archetypes)
+			{
+				if ((archetype->signature & mask) == mask)
+					matching.push_back(archetype.get());
+			}
+			return ArchetypeView<ComponentTypes...>(std::move(matching), { mutableState<ComponentTypes>()... });
+		}
+
+		// every entity that has the component, gathered from the archetype chunks on each call.
+		// the reference stays valid until the next call for the same type
+		template<typename ComponentType>
+		const std::vector<entity_t>& getEntities()
+		{
+			const int32_t componentTypeID = ComponentTypeSquence<ComponentType>::value();
+			std::vector<entity_t>& owners = states[componentTypeID].owners;
+			owners.clear();
+			for (std::unique_ptr<Archetype>& archetype : archetypes)
+			{
+				if (!archetype->hasComponent(componentTypeID))
+					continue;
+				for (std::unique_ptr<Archetype::Chunk>& chunk : archetype->chunks)
+					owners.insert(owners.end(), archetype->entities(*chunk), archetype->entities(*chunk) + chunk->count);
+			}
+			return owners;
+		}
+
+		template<typename ComponentType>
+		uint32_t getStructureVersion()
+		{
+			return states[ComponentTypeSquence<ComponentType>::value()].structureVersion;
+		}
+
+		// copies the components into destination in the order of getEntities
+		template<typename ComponentType>
+		void copyComponents(ComponentType* destination)
+		{
+			const int32_t componentTypeID = ComponentTypeSquence<ComponentType>::value();
+			for (std::unique_ptr<Archetype>& archetype : archetypes)
+			{
+				if (!archetype->hasComponent(componentTypeID))
+					continue;
+				for (std::unique_ptr<Archetype::Chunk>& chunk : archetype->chunks)
+					destination = std::copy_n(archetype->column<ComponentType>(*chunk, componentTypeID), chunk->count, destination);
+			}
+		}
+
+		bool isValid(entity_t entity)
+		{
+			return entity < static_cast<entity_t>(entities.size()) && entities[entity] == entity;
+		}
+
+		int32_t size() const
+		{
+			int32_t out = static_cast<int32_t>(entities.size());
+			int32_t curr = availableEntity;
+			for (; curr != -1; --out)
+				curr = entities[curr];
+
+			return out;
+		}
+
+		int32_t capacity() const
+		{
+			return static_cast<int32_t>(entities.size());
+		}
+
+	private:
+		struct EntityLocation
+		{
+			Archetype* archetype = nullptr;
+			int32_t chunk = 0;
+			int32_t row = 0;
+		};
+
+		Archetype* getOrCreateArchetype(ArchetypeSignature signature)
+		{
+			auto found = archetypeMap.find(signature);
+			if (found != archetypeMap.end())
+				return found->second;
+
+			Archetype* archetype = archetypes.emplace_back(std::make_unique<Archetype>(signature, typeInfos)).get();
+			int32_t initialCapacity = 0;
+			for (int32_t componentID : archetype->componentIDs)
+				initialCapacity = std::max(initialCapacity, states[componentID].initialCapacity);
+			archetype->chunks.reserve((initialCapacity + archetype->chunkCapacity - 1) / archetype->chunkCapacity);
+			return archetypeMap[signature] = archetype;
+		}
+
+		// creates count entities with consecutive ids in archetype, its components are default
+		// constructed and reported as added
+		entity_t appendEntities(int32_t count, Archetype* archetype)
+		{
+			const entity_t first = capacity();
+			entities.resize(first + count);
+			std::iota(entities.begin() + first, entities.end(), first);
+			locations.resize(first + count);
+			for (ArchetypeComponentState& state : states)
+				state.resizeEntitySlots(capacity());
+
+			for (entity_t entity = first; entity < first + count; entity++)
+			{
+				EntityLocation& location = locations[entity];
+				location.archetype = archetype;
+				archetype->allocateRow(entity, location.chunk, location.row);
+				Archetype::Chunk& chunk = *archetype->chunks[location.chunk];
+				for (size_t column = 0; column < archetype->componentIDs.size(); column++)
+					archetype->columnTypes[column]->construct(archetype->componentAt(chunk, column, location.row));
+			}
+
+			for (int32_t componentID : archetype->componentIDs)
+			{
+				ArchetypeComponentState& state = states[componentID];
+				state.structureVersion++;
+				if (state.observedEvents & COMPONENT_ADDED)
+					state.addedEntities.insert(state.addedEntities.end(), entities.begin() + first, entities.end());
+			}
+			return first;
+		}
+
+		template<typename ComponentType>
+		ComponentType& componentOf(entity_t entity)
+		{
+			assert(HasComponent<ComponentType>(entity) && "entity don't have such component.");
+			const EntityLocation& location = locations[entity];
+			Archetype::Chunk& chunk = *location.archetype->chunks[location.chunk];
+			return location.archetype->column<ComponentType>(chunk, ComponentTypeSquence<ComponentType>::value())[location.row];
+		}
+
+		template<typename ComponentType>
+		ArchetypeComponentState* mutableState()
+		{
+			if constexpr (std::is_const_v<ComponentType>)
+				return nullptr;
+			else
+				return &states[ComponentTypeSquence<ComponentType>::value()];
+		}
+
+		// moves entity's components into destination, constructing the ones it didn't have
+		void moveEntity(entity_t entity, Archetype* destination)
+		{
+			EntityLocation& location = locations[entity];
+			Archetype* source = location.archetype;
+			Archetype::Chunk& sourceChunk = *source->chunks[location.chunk];
+
+			int32_t chunkIndex, row;
+			destination->allocateRow(entity, chunkIndex, row);
+			Archetype::Chunk& destinationChunk = *destination->chunks[chunkIndex];
+
+			size_t sourceColumn = 0;
+			for (size_t column = 0; column < destination->componentIDs.size(); column++)
+			{
+				const int32_t componentID = destination->componentIDs[column];
+				void* component = destination->componentAt(destinationChunk, column, row);
+				// both component id lists are sorted, so walk them together
+				while (sourceColumn < source->componentIDs.size() && source->componentIDs[sourceColumn] < componentID)
+					sourceColumn++;
+
+				if (sourceColumn < source->componentIDs.size() && source->componentIDs[sourceColumn] == componentID)
+					destination->columnTypes[column]->moveConstruct(component, source->componentAt(sourceChunk, sourceColumn, location.row));
+				else
+					destination->columnTypes[column]->construct(component);
+			}
+
+			fixMovedEntity(location, source->removeRow(location.chunk, location.row));
+			location.archetype = destination;
+			location.chunk = chunkIndex;
+			location.row = row;
+		}
+
+		// an entity moved into the row that was just freed, point its location there
+		void fixMovedEntity(const EntityLocation& freedLocation, entity_t movedEntity)
+		{
+			if (movedEntity != -1)
+			{
+				locations[movedEntity].chunk = freedLocation.chunk;
+				locations[movedEntity].row = freedLocation.row;
+			}
+		}
+
+		entity_t availableEntity;
+		std::vector<entity_t> entities;
+		std::vector<EntityLocation> locations;
+		std::vector<ComponentTypeInfo> typeInfos;
+		std::vector<ArchetypeComponentState> states;
+		std::vector<std::unique_ptr<Archetype>> archetypes;
+		std::unordered_map<ArchetypeSignature, Archetype*> archetypeMap;
+		DestroyHook destroyHook;
+	};
+
+	// the api both backends have to keep, so code written against one of them builds with the other
+	template<typename Manager, typename ComponentType>
+	concept EntityManagerBackend = requires(Manager& manager, entity_t entity, std::vector<uint64_t>& bits, std::vector<entity_t>& outEntities,
+		ComponentObserver observer, const BasicPrefab<Manager>& prefab, ComponentType* components, void (*function)(entity_t, ComponentType&))
+	{
+		manager.template registerComponent<ComponentType>(0);
+		manager.reserveEntities(0);
+		{ manager.createEntity() } -> std::same_as<entity_t>;
+		{ manager.createEntities(0) } -> std::same_as<entity_t>;
+		{ manager.instantiate(prefab, 0) } -> std::same_as<std::span<const entity_t>>;
+		manager.template addComponents<ComponentType>(entity, 0, ComponentType{});
+		manager.destroyEntity(entity);
+		manager.reset();
+		manager.restoreEntities(&entity, 0, entity);
+		manager.template restoreComponents<ComponentType>(&entity, components, 0);
+		{ manager.getEntityTable() } -> std::same_as<const std::vector<entity_t>&>;
+		{ manager.getAvailableEntity() } -> std::same_as<entity_t>;
+		{ manager.template AddComponent<ComponentType>(entity) } -> std::same_as<ComponentType&>;
+		manager.template RemoveComponent<ComponentType>(entity);
+		{ manager.template HasComponent<ComponentType>(entity) } -> std::same_as<bool>;
+		{ manager.template HasComponents<ComponentType>(entity) } -> std::same_as<bool>;
+		{ manager.matches(entity, ComponentMask{}) } -> std::same_as<bool>;
+		{ manager.getSignature(entity) } -> std::same_as<ComponentMask>;
+		manager.filterEntities(ComponentMask{}, outEntities);
+		{ manager.template GetComponent<ComponentType>(entity) } -> std::same_as<ComponentType&>;
+		{ manager.template ReadComponent<ComponentType>(entity) } -> std::same_as<const ComponentType&>;
+		manager.template takeChanges<ComponentType>(bits);
+		{ manager.template observe<ComponentType>(COMPONENT_ADDED, observer) } -> std::same_as<ObserverID>;
+		manager.template removeObserver<ComponentType>(ObserverID{});
+		manager.flushObservers();
+		manager.setDestroyHook(DestroyHook{});
+		{ manager.template getEntities<ComponentType>() } -> std::same_as<const std::vector<entity_t>&>;
+		{ manager.template getStructureVersion<ComponentType>() } -> std::same_as<uint32_t>;
+		manager.template copyComponents<ComponentType>(components);
+		manager.template view<ComponentType>().begin();
+		manager.template view<const ComponentType>().begin();
+		{ manager.template view<ComponentType>().size() } -> std::same_as<int32_t>;
+		manager.template view<ComponentType>().each(0, 0, function);
+		{ manager.isValid(entity) } -> std::same_as<bool>;
+		{ manager.size() } -> std::same_as<int32_t>;
+		{ manager.capacity() } -> std::same_as<int32_t>;
+	};
+
+	namespace archetype_detail
+	{
+		struct BackendCheckComponent
+		{
+			int32_t value;
+		};
+	}
+	static_assert(EntityManagerBackend<EntityManager, archetype_detail::BackendCheckComponent>, "EntityManager lost part of the shared api.");
+	static_assert(EntityManagerBackend<ArchetypeEntityManager, archetype_detail::BackendCheckComponent>, "ArchetypeEntityManager lost part of the shared api.");
+
+	// the backend VeObjectManager and the engine systems are built on, the VE_ARCHETYPE_ECS
+	// build option swaps in the archetype one
+#ifdef VE_ARCHETYPE_ECS
+	typedef ArchetypeEntityManager SceneEntityManager;
+#else
+	typedef EntityManager SceneEntityManager;
+#endif
+	typedef BasicPrefab<SceneEntityManager> ScenePrefab;
+}
@@ -0,0 +1,154 @@
+#include "ve_entity_command_buffer.h"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+namespace ve
+{
+	// placeholders are negative, -1 stays the invalid entity
+	// placeholder = -(localIndex * numThreads + threadIndex) - 2
+
+	EntityCommandBuffer::EntityCommandBuffer(uint32_t numThreads) : threadBuffers(numThreads)
+	{
+	}
+
+	EntityCommandBuffer::~EntityCommandBuffer()
+	{
+		for (ThreadBuffer& buffer : threadBuffers)
+		{
+			for (Command& command : buffer.commands)
+			{
+				if (command.destroy)
+					command.destroy(command.payload);
+			}
+		}
+	}
+
+	EntityCommandBuffer::ThreadBuffer& EntityCommandBuffer::getThreadBuffer()
+	{
+		const uint32_t threadIndex = VeJobSystem::getThreadIndex();
+		assert(threadIndex < threadBuffers.size() && "Command buffer has no buffer for this thread.");
+		return threadBuffers[threadIndex];
+	}
+
+	entity_t EntityCommandBuffer::createEntity()
+	{
+		const uint32_t threadIndex = VeJobSystem::getThreadIndex();
+		ThreadBuffer& buffer = getThreadBuffer();
+		const entity_t placeholder = -(buffer.numCreated++ * static_cast<entity_t>(threadBuffers.size()) + static_cast<entity_t>(threadIndex)) - 2;
+		buffer.commands.push_back({ placeholder, nullptr, nullptr, nullptr });
+		return placeholder;
+	}
+
+	void EntityCommandBuffer::destroyEntity(entity_t entity)
+	{
+		getThreadBuffer().commands.push_back({ entity, &applyDestroy, nullptr, nullptr });
+	}
+
+	void EntityCommandBuffer::applyDestroy(SceneEntityManager& manager, entity_t entity, void* payload)
+	{
+		// several threads may have asked for the same entity to be destroyed
+		if (manager.isValid(entity))
+			manager.destroyEntity(entity);
+	}
+
+	entity_t EntityCommandBuffer::resolve(entity_t entity, const std::vector<std::vector<entity_t>>& createdEntities) const
+	{
+		if (entity >= 0)
+			return entity;
+
+		const entity_t encoded = -entity - 2;
+		const entity_t numThreads = static_cast<entity_t>(threadBuffers.size());
+		return createdEntities[encoded % numThreads][encoded / numThreads];
+	}
+
+	void EntityCommandBuffer::playback(SceneEntityManager& manager)
+	{
+		int32_t totalCreated = 0;
+		std::vector<std::vector<entity_t>> createdEntities(threadBuffers.size());
+		for (size_t thread = 0; thread < threadBuffers.size(); thread++)
+		{
+			createdEntities[thread].reserve(threadBuffers[thread].numCreated);
+			totalCreated += threadBuffers[thread].numCreated;
+		}
+		manager.reserveEntities(manager.capacity() + totalCreated);
+
+		// entities are created first and destroyed last, so a new entity never reuses
+		// an id that a command of this playback still refers to
+		for (size_t thread = 0; thread < threadBuffers.size(); thread++)
+		{
+			for (Command& command : threadBuffers[thread].commands)
+			{
+				if (!command.apply)
+					createdEntities[thread].push_back(manager.createEntity());
+			}
+		}
+
+		for (ThreadBuffer& buffer : threadBuffers)
+		{
+			for (Command& command : buffer.commands)
+			{
+				if (command.apply && command.apply != &applyDestroy)
+					command.apply(manager, resolve(command.entity, createdEntities), command.payload);
+				if (command.destroy)
+					command.destroy(command.payload);
+			}
+		}
+
+		for (ThreadBuffer& buffer : threadBuffers)
+		{
+			for (Command& command : buffer.commands)
+			{
+				if (command.apply == &applyDestroy)
+					applyDestroy(manager, resolve(command.entity, createdEntities), nullptr);
+			}
+
+			buffer.commands.clear();
+			buffer.payloads.clear();
+			buffer.numCreated = 0;
+		}
+	}
+
+	bool EntityCommandBuffer::isEmpty() const
+	{
+		for (const ThreadBuffer& buffer : threadBuffers)
+		{
+			if (!buffer.commands.empty())
+				return false;
+		}
+		return true;
+	}
+
+	void* EntityCommandBuffer::PayloadArena::allocate(size_t size, size_t alignment)
+	{
+		while (true)
+		{
+			if (currentBlock < blocks.size())
+			{
+				const uintptr_t base = reinterpret_cast<uintptr_t>(blocks[currentBlock].get());
+				const size_t aligned = ((base + offset + alignment - 1) & ~(alignment - 1)) - base;
+				if (aligned + size <= blockSizes[currentBlock])
+				{
+					offset = aligned + size;
+					return blocks[currentBlock].get() + aligned;
+				}
+				currentBlock++;
+				offset = 0;
+				continue;
+			}
+
+			// payloads bigger than a block get a block of their own
+			const size_t blockSize = std::max(BLOCK_SIZE, size + alignment);
+			blocks.push_back(std::make_unique<std::byte[]>(blockSize));
+			blockSizes.push_back(blockSize);
+		}
+	}
+
+	void EntityCommandBuffer::PayloadArena::clear()
+	{
+		currentBlock = 0;
+		offset = 0;
+	}
+}
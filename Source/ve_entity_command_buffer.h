@@ -0,0 +1,116 @@
+#pragma once
+
+#include "ve_ecs_archetype.h"
+#include "ve_job_system.h"
+
+// std
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace ve
+{
+	// records structural changes (create/destroy entities, add/remove/set components) from any
+	// number of threads and applies them to the SceneEntityManager later in one pass, at a point where
+	// nothing iterates the pools. every thread appends to its own buffer, so recording takes no
+	// locks. entities created through the buffer get a placeholder id that can be used by later
+	// commands recorded on the same thread, playback swaps it for the real id.
+	class EntityCommandBuffer
+	{
+	public:
+		explicit EntityCommandBuffer(uint32_t numThreads);
+		~EntityCommandBuffer();
+
+		EntityCommandBuffer(const EntityCommandBuffer&) = delete;
+		EntityCommandBuffer& operator=(const EntityCommandBuffer&) = delete;
+
+		entity_t createEntity();
+		void destroyEntity(entity_t entity);
+
+		template<typename ComponentType>
+		void addComponent(entity_t entity, ComponentType component = ComponentType())
+		{
+			record(entity, std::move(component), [](SceneEntityManager& manager, entity_t target, void* payload)
+			{
+				manager.AddComponent<ComponentType>(target) = std::move(*static_cast<ComponentType*>(payload));
+			});
+		}
+
+		template<typename ComponentType>
+		void setComponent(entity_t entity, ComponentType component)
+		{
+			record(entity, std::move(component), [](SceneEntityManager& manager, entity_t target, void* payload)
+			{
+				manager.GetComponent<ComponentType>(target) = std::move(*static_cast<ComponentType*>(payload));
+			});
+		}
+
+		template<typename ComponentType>
+		void removeComponent(entity_t entity)
+		{
+			getThreadBuffer().commands.push_back({ entity, [](SceneEntityManager& manager, entity_t target, void* payload)
+			{
+				if (manager.HasComponent<ComponentType>(target))
+					manager.RemoveComponent<ComponentType>(target);
+			}, nullptr, nullptr });
+		}
+
+		// applies the recorded commands and clears the buffer. all entities are created first, then
+		// component commands run thread by thread in recording order and destroys are applied last.
+		// must not run while other threads are recording
+		void playback(SceneEntityManager& manager);
+
+		bool isEmpty() const;
+
+	private:
+		typedef void (*ApplyFunction)(SceneEntityManager& manager, entity_t entity, void* payload);
+		typedef void (*DestroyFunction)(void* payload);
+
+		struct Command
+		{
+			entity_t entity;
+			// nullptr for entity creation, the placeholder is stored in entity
+			ApplyFunction apply;
+			DestroyFunction destroy;
+			void* payload;
+		};
+
+		// payload memory is handed out from blocks that never move, so components that aren't
+		// trivially copyable stay valid until playback
+		struct PayloadArena
+		{
+			static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+			void* allocate(size_t size, size_t alignment);
+			void clear();
+
+			std::vector<std::unique_ptr<std::byte[]>> blocks;
+			std::vector<size_t> blockSizes;
+			size_t currentBlock = 0;
+			size_t offset = 0;
+		};
+
+		struct alignas(64) ThreadBuffer
+		{
+			std::vector<Command> commands;
+			PayloadArena payloads;
+			int32_t numCreated = 0;
+		};
+
+		template<typename ComponentType>
+		void record(entity_t entity, ComponentType&& component, ApplyFunction apply)
+		{
+			ThreadBuffer& buffer = getThreadBuffer();
+			void* payload = buffer.payloads.allocate(sizeof(ComponentType), alignof(ComponentType));
+			new (payload) ComponentType(std::move(component));
+			buffer.commands.push_back({ entity, apply, [](void* ptr) { static_cast<ComponentType*>(ptr)->~ComponentType(); }, payload });
+		}
+
+		static void applyDestroy(SceneEntityManager& manager, entity_t entity, void* payload);
+
+		ThreadBuffer& getThreadBuffer();
+		entity_t resolve(entity_t entity, const std::vector<std::vector<entity_t>>& createdEntities) const;
+
+		std::vector<ThreadBuffer> threadBuffers;
+	};
+}
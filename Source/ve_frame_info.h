@@ -35,7 +35,6 @@ namespace ve
         VkCommandBuffer commandBuffer;
         VeCamera& camera;
         VkDescriptorSet globalDescriptorSet;
-        VeDescriptorPool& frameDescriptorPool;
         VeObjectManager& entityManager;
     };
 
@@ -0,0 +1,154 @@
+#include "ve_job_system.h"
+
+// std
+#include <cassert>
+
+namespace ve
+{
+	static thread_local uint32_t threadIndex = 0;
+
+	VeJobSystem::VeJobSystem(uint32_t numThreads)
+	{
+		numThreads = std::max(numThreads, 1u);
+		for (uint32_t i = 0; i < numThreads; i++)
+			queues.push_back(std::make_unique<WorkQueue>());
+
+		for (uint32_t i = 1; i < numThreads; i++)
+			workers.emplace_back(&VeJobSystem::workerLoop, this, i);
+	}
+
+	VeJobSystem::~VeJobSystem()
+	{
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			running = false;
+		}
+		wakeCondition.notify_all();
+		for (std::thread& worker : workers)
+			worker.join();
+	}
+
+	uint32_t VeJobSystem::getThreadIndex()
+	{
+		return threadIndex;
+	}
+
+	void VeJobSystem::schedule(std::function<void()> function, JobCounter* counter /*= nullptr*/)
+	{
+		if (counter)
+			counter->value.fetch_add(1, std::memory_order_relaxed);
+		push({ std::move(function), counter });
+	}
+
+	void VeJobSystem::scheduleAfter(JobCounter& dependency, std::function<void()> function, JobCounter* counter /*= nullptr*/)
+	{
+		if (counter)
+			counter->value.fetch_add(1, std::memory_order_relaxed);
+
+		Job job{ std::move(function), counter };
+		{
+			std::lock_guard<std::mutex> lock(dependency.continuationMutex);
+			if (!dependency.isDone())
+			{
+				dependency.continuations.push_back(std::move(job));
+				return;
+			}
+		}
+		push(std::move(job));
+	}
+
+	void VeJobSystem::wait(JobCounter& counter)
+	{
+		while (!counter.isDone())
+		{
+			if (!tryRunJob())
+				std::this_thread::yield();
+		}
+		// the job that finished the counter may still be releasing it, don't let the caller destroy it before that
+		std::lock_guard<std::mutex> lock(counter.continuationMutex);
+	}
+
+	void VeJobSystem::workerLoop(uint32_t index)
+	{
+		threadIndex = index;
+		while (running)
+		{
+			if (!tryRunJob())
+			{
+				std::unique_lock<std::mutex> lock(sleepMutex);
+				wakeCondition.wait(lock, [this]() { return !running || queuedJobs > 0; });
+			}
+		}
+	}
+
+	void VeJobSystem::push(Job&& job)
+	{
+		WorkQueue& queue = *queues[threadIndex < queues.size() ? threadIndex : 0];
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.jobs.push_back(std::move(job));
+		}
+		queuedJobs.fetch_add(1);
+
+		// taking the lock makes sure a worker that just found no work is already waiting
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+		}
+		wakeCondition.notify_one();
+	}
+
+	bool VeJobSystem::tryRunJob()
+	{
+		const uint32_t ownIndex = threadIndex < queues.size() ? threadIndex : 0;
+		Job job;
+		bool found = false;
+
+		// newest job of our own queue first, it's the most likely to be in cache
+		{
+			WorkQueue& queue = *queues[ownIndex];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.jobs.empty())
+			{
+				job = std::move(queue.jobs.back());
+				queue.jobs.pop_back();
+				found = true;
+			}
+		}
+
+		// otherwise steal the oldest job of another thread
+		for (uint32_t i = 1; !found && i < queues.size(); i++)
+		{
+			WorkQueue& queue = *queues[(ownIndex + i) % queues.size()];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.jobs.empty())
+			{
+				job = std::move(queue.jobs.front());
+				queue.jobs.pop_front();
+				found = true;
+			}
+		}
+
+		if (!found)
+			return false;
+
+		queuedJobs.fetch_sub(1);
+		job.function();
+		finishJob(job.counter);
+		return true;
+	}
+
+	void VeJobSystem::finishJob(JobCounter* counter)
+	{
+		if (!counter)
+			return;
+
+		std::vector<Job> ready;
+		{
+			std::lock_guard<std::mutex> lock(counter->continuationMutex);
+			if (counter->value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				ready.swap(counter->continuations);
+		}
+		for (Job& job : ready)
+			push(std::move(job));
+	}
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ve
+{
+	class JobCounter;
+
+	struct Job
+	{
+		std::function<void()> function;
+		JobCounter* counter = nullptr;
+	};
+
+	// number of unfinished jobs attached to it. jobs scheduled after a counter only become
+	// runnable once it drops to zero, which is how dependencies between jobs are expressed.
+	class JobCounter
+	{
+	public:
+		JobCounter() = default;
+		JobCounter(const JobCounter&) = delete;
+		JobCounter& operator=(const JobCounter&) = delete;
+
+		bool isDone() const
+		{
+			return value.load(std::memory_order_acquire) == 0;
+		}
+
+	private:
+		friend class VeJobSystem;
+
+		std::atomic<int32_t> value{ 0 };
+		std::mutex continuationMutex;
+		std::vector<Job> continuations;
+	};
+
+	// work stealing thread pool. every thread owns a deque, it pushes and pops its own jobs at the
+	// back and idle threads steal from the front of the others. the thread that creates the
+	// job system is thread 0 and takes part in the work whenever it waits on a counter.
+	class VeJobSystem
+	{
+	public:
+		explicit VeJobSystem(uint32_t numThreads = std::thread::hardware_concurrency());
+		~VeJobSystem();
+
+		VeJobSystem(const VeJobSystem&) = delete;
+		VeJobSystem& operator=(const VeJobSystem&) = delete;
+
+		void schedule(std::function<void()> function, JobCounter* counter = nullptr);
+		// function runs once dependency is done
+		void scheduleAfter(JobCounter& dependency, std::function<void()> function, JobCounter* counter = nullptr);
+		// runs other jobs while waiting, so it never blocks a thread that could do work
+		void wait(JobCounter& counter);
+
+		// calls function(begin, end) for consecutive ranges of at most grainSize items covering [0, count)
+		template<typename Function>
+		void parallelFor(int32_t count, int32_t grainSize, Function&& function)
+		{
+			if (count <= 0)
+				return;
+			if (count <= grainSize || queues.size() == 1)
+			{
+				function(0, count);
+				return;
+			}
+
+			JobCounter counter;
+			for (int32_t begin = grainSize; begin < count; begin += grainSize)
+			{
+				const int32_t end = std::min(begin + grainSize, count);
+				schedule([&function, begin, end]() { function(begin, end); }, &counter);
+			}
+			// the calling thread takes the first range itself
+			function(0, std::min(grainSize, count));
+			wait(counter);
+		}
+
+		// calls function(entity, components...) for every entity of an EntityView, split over the workers
+		template<typename View, typename Function>
+		void parallelForEach(View&& view, int32_t grainSize, Function&& function)
+		{
+			parallelFor(view.size(), grainSize, [&view, &function](int32_t begin, int32_t end) {
+				view.each(begin, end, function);
+			});
+		}
+
+		uint32_t getNumThreads() const { return static_cast<uint32_t>(queues.size()); }
+
+		// index of the calling thread in this job system, 0 for the thread that created it
+		static uint32_t getThreadIndex();
+
+	private:
+		struct WorkQueue
+		{
+			std::mutex mutex;
+			std::deque<Job> jobs;
+		};
+
+		void workerLoop(uint32_t threadIndex);
+		void push(Job&& job);
+		bool tryRunJob();
+		void finishJob(JobCounter* counter);
+
+		std::vector<std::unique_ptr<WorkQueue>> queues;
+		std::vector<std::thread> workers;
+
+		std::atomic<bool> running{ true };
+		std::atomic<int32_t> queuedJobs{ 0 };
+		std::mutex sleepMutex;
+		std::condition_variable wakeCondition;
+	};
+}
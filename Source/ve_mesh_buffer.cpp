@@ -0,0 +1,144 @@
+#include "ve_mesh_buffer.h"
+
+#include "ve_model.h"
+
+// std
+#include <cassert>
+#include <iterator>
+#include <numeric>
+#include <vector>
+
+namespace ve
+{
+	VeMeshBuffer::VeMeshBuffer(VeDevice& device) : veDevice(device)
+	{
+		assert(!device.getMeshBuffer() && "The device already has a mesh buffer.");
+
+		// growing copies the old buffer into the new one, so both ends of a copy are needed
+		vertices.elementSize = sizeof(VeModel::Vertex);
+		vertices.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		vertices.initialCapacity = INITIAL_VERTEX_CAPACITY;
+		indices.elementSize = sizeof(uint32_t);
+		indices.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		indices.initialCapacity = INITIAL_INDEX_CAPACITY;
+
+		device.setMeshBuffer(this);
+	}
+
+	VeMeshBuffer::~VeMeshBuffer()
+	{
+		veDevice.setMeshBuffer(nullptr);
+	}
+
+	VeMeshBuffer::Range VeMeshBuffer::add(const void* vertexData, uint32_t vertexCount, const uint32_t* indexData, uint32_t indexCount)
+	{
+		assert(vertexCount > 0 && "Mesh has no vertices.");
+
+		std::vector<uint32_t> sequentialIndices;
+		if (indexCount == 0)
+		{
+			sequentialIndices.resize(vertexCount);
+			std::iota(sequentialIndices.begin(), sequentialIndices.end(), 0u);
+			indexData = sequentialIndices.data();
+			indexCount = vertexCount;
+		}
+
+		Range range{};
+		range.vertexCount = vertexCount;
+		range.indexCount = indexCount;
+		range.vertexOffset = static_cast<int32_t>(allocate(vertices, vertexCount));
+		range.firstIndex = allocate(indices, indexCount);
+		upload(vertices, vertexData, static_cast<uint32_t>(range.vertexOffset), vertexCount);
+		upload(indices, indexData, range.firstIndex, indexCount);
+		return range;
+	}
+
+	void VeMeshBuffer::remove(const Range& range)
+	{
+		release(vertices, static_cast<uint32_t>(range.vertexOffset), range.vertexCount);
+		release(indices, range.firstIndex, range.indexCount);
+	}
+
+	void VeMeshBuffer::bind(VkCommandBuffer commandBuffer)
+	{
+		if (!vertices.buffer)
+			return;
+
+		VkDeviceSize offset = 0;
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertices.buffer->getBuffer(), &offset);
+		vkCmdBindIndexBuffer(commandBuffer, indices.buffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
+	}
+
+	uint32_t VeMeshBuffer::allocate(Storage& storage, uint32_t count)
+	{
+		for (;;)
+		{
+			// first fit, meshes are added rarely and there are few free ranges
+			for (auto it = storage.freeRanges.begin(); it != storage.freeRanges.end(); ++it)
+			{
+				if (it->second < count)
+					continue;
+
+				const uint32_t offset = it->first;
+				const uint32_t remaining = it->second - count;
+				storage.freeRanges.erase(it);
+				if (remaining > 0)
+					storage.freeRanges.emplace(offset + count, remaining);
+				return offset;
+			}
+
+			const uint32_t oldCapacity = storage.buffer ? storage.buffer->getInstanceCount() : 0;
+			uint32_t capacity = oldCapacity > 0 ? oldCapacity : storage.initialCapacity;
+			while (capacity - oldCapacity < count)
+				capacity *= 2;
+
+			auto grown = std::make_unique<VeBuffer>(veDevice, storage.elementSize, capacity, storage.usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			// the copy waits for the queue to be idle, so no frame uses the old buffer after it
+			if (storage.buffer)
+				veDevice.copyBuffer(storage.buffer->getBuffer(), grown->getBuffer(), storage.buffer->getBufferSize());
+			storage.buffer = std::move(grown);
+			release(storage, oldCapacity, capacity - oldCapacity);
+		}
+	}
+
+	void VeMeshBuffer::release(Storage& storage, uint32_t offset, uint32_t count)
+	{
+		if (count == 0)
+			return;
+
+		auto next = storage.freeRanges.lower_bound(offset);
+		assert((next == storage.freeRanges.end() || offset + count <= next->first) && "Range overlaps a free range.");
+		if (next != storage.freeRanges.end() && offset + count == next->first)
+		{
+			count += next->second;
+			next = storage.freeRanges.erase(next);
+		}
+		if (next != storage.freeRanges.begin())
+		{
+			auto previous = std::prev(next);
+			assert(previous->first + previous->second <= offset && "Range overlaps a free range.");
+			if (previous->first + previous->second == offset)
+			{
+				previous->second += count;
+				return;
+			}
+		}
+		storage.freeRanges.emplace(offset, count);
+	}
+
+	void VeMeshBuffer::upload(Storage& storage, const void* data, uint32_t offset, uint32_t count)
+	{
+		VeBuffer stagingBuffer{
+			veDevice,
+			storage.elementSize,
+			count,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+		};
+		stagingBuffer.map();
+		stagingBuffer.writeToBuffer(const_cast<void*>(data));
+		stagingBuffer.unmap();
+
+		veDevice.copyBuffer(stagingBuffer.getBuffer(), storage.buffer->getBuffer(), stagingBuffer.getBufferSize(), storage.elementSize * offset);
+	}
+}
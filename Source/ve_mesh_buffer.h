@@ -0,0 +1,63 @@
+#pragma once
+
+#include "ve_buffer.h"
+
+// std
+#include <map>
+#include <memory>
+
+namespace ve
+{
+	// one vertex buffer and one index buffer holding the meshes of every model, so all models are
+	// drawn with the same bindings and one indirect draw can cover all of them. models add their
+	// mesh on creation and keep its range for their whole lifetime
+	class VeMeshBuffer
+	{
+	public:
+		static constexpr uint32_t INITIAL_VERTEX_CAPACITY = 1 << 16;
+		static constexpr uint32_t INITIAL_INDEX_CAPACITY = 1 << 18;
+
+		// where a mesh lives in the shared buffers
+		struct Range
+		{
+			uint32_t indexCount = 0;
+			uint32_t firstIndex = 0;
+			int32_t vertexOffset = 0;
+			uint32_t vertexCount = 0;
+		};
+
+		// there is one mesh buffer per device, it's set on the device for models to find it
+		VeMeshBuffer(VeDevice& device);
+		~VeMeshBuffer();
+
+		VeMeshBuffer(const VeMeshBuffer&) = delete;
+		VeMeshBuffer& operator=(const VeMeshBuffer&) = delete;
+
+		// the buffers grow when the mesh doesn't fit, which waits for the device to be idle like
+		// every other upload. meshes without indices get one index per vertex
+		Range add(const void* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount);
+		// freed ranges are reused, a model must not be destroyed while a frame in flight draws it
+		void remove(const Range& range);
+
+		void bind(VkCommandBuffer commandBuffer);
+
+	private:
+		struct Storage
+		{
+			std::unique_ptr<VeBuffer> buffer;
+			VkDeviceSize elementSize;
+			VkBufferUsageFlags usage;
+			uint32_t initialCapacity;
+			// offset -> count of every free range, neighbouring ranges are merged
+			std::map<uint32_t, uint32_t> freeRanges;
+		};
+
+		uint32_t allocate(Storage& storage, uint32_t count);
+		static void release(Storage& storage, uint32_t offset, uint32_t count);
+		void upload(Storage& storage, const void* data, uint32_t offset, uint32_t count);
+
+		VeDevice& veDevice;
+		Storage vertices;
+		Storage indices;
+	};
+}
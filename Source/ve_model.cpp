@@ -10,6 +10,7 @@
 #include <cassert>
 #include <cstring>
 #include <iostream>
+#include <stdexcept>
 
 namespace std
 {
@@ -27,15 +28,27 @@ namespace std
 
 namespace ve
 {
+	static VeMeshBuffer& requireMeshBuffer(VeDevice& device)
+	{
+		VeMeshBuffer* meshBuffer = device.getMeshBuffer();
+		if (!meshBuffer)
+			throw std::runtime_error("failed to create model, the device has no mesh buffer!");
+		return *meshBuffer;
+	}
+
 	VeModel::VeModel(VeDevice& device, const VeModel::Builder& builder)
-		: veDevice(device), hasIndexBuffer(false)
+		: meshBuffer(requireMeshBuffer(device))
 	{
-		createVertexBuffers(builder.vertices);
-		createIndexBuffers(builder.indices);
+		assert(builder.vertices.size() >= 3 && "Vertex count must be at least 3");
+		computeBoundingSphere(builder.vertices);
+		meshRange = meshBuffer.add(
+			builder.vertices.data(), static_cast<uint32_t>(builder.vertices.size()),
+			builder.indices.data(), static_cast<uint32_t>(builder.indices.size()));
 	}
 
 	VeModel::~VeModel()
 	{
+		meshBuffer.remove(meshRange);
 	}
 
 	std::unique_ptr<VeModel> VeModel::createModelFromFile(VeDevice& device, const std::string& filepath)
@@ -48,97 +61,29 @@ namespace ve
 
 	void VeModel::bind(VkCommandBuffer commandBuffer)
 	{
-		VkDeviceSize offset = 0;
-		vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer->getBuffer(), &offset);
-		if (hasIndexBuffer)
-			vkCmdBindIndexBuffer(commandBuffer, indexBuffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
-	}
-
-	void VeModel::draw(VkCommandBuffer commandBuffer)
-	{
-		if (hasIndexBuffer)
-			vkCmdDrawIndexed(commandBuffer, indexCount, 1, 0, 0, 0);
-		else
-			vkCmdDraw(commandBuffer, vertexCount, 1, 0, 0);
+		meshBuffer.bind(commandBuffer);
 	}
 
-
-
-	void VeModel::createVertexBuffers(const std::vector<Vertex>& vertices)
+	void VeModel::draw(VkCommandBuffer commandBuffer, uint32_t instanceCount, uint32_t firstInstance)
 	{
-		vertexCount = static_cast<uint32_t>(vertices.size());
-		assert(vertexCount >= 3 && "Vertex count must be at least 3");
-
-		uint32_t vertexSize = sizeof(vertices[0]);
-
-		// NOTE host means cpu and device means gpu
-		// VK_BUFFER_USAGE_TRANSFER_SRC_BIT tell vulkan that the buffer we are creating is going to be used as the source location for our memroy transfer operation.
-		// VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT  staging buffer will need to be host visible
-		// VK_MEMORY_PROPERTY_HOST_COHERENT_BIT whenever we change data on the host side to automatically flush that data to the device side
-
-		VeBuffer stagingBuffer{
-			veDevice,
-			vertexSize,
-			vertexCount,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-		};
-
-		stagingBuffer.map();
-		stagingBuffer.writeToBuffer((void*)vertices.data());
-		stagingBuffer.unmap();
-
-	// VK_BUFFER_USAGE_TRANSFER_DST_BIT this will be the destination of transfering data from staging buffer.
-	// VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT the most optimal but it can be accessed only by a staging buffer.
-
-		vertexBuffer = std::make_unique<VeBuffer>(
-			veDevice,
-			vertexSize,
-			vertexCount,
-			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-		);
-
-		veDevice.copyBuffer(stagingBuffer.getBuffer(), vertexBuffer->getBuffer(), vertexBuffer->getBufferSize());
+		vkCmdDrawIndexed(commandBuffer, meshRange.indexCount, instanceCount, meshRange.firstIndex, meshRange.vertexOffset, firstInstance);
 	}
 
-	void VeModel::createIndexBuffers(const std::vector<uint32_t>& indices)
+	void VeModel::computeBoundingSphere(const std::vector<Vertex>& vertices)
 	{
-		indexCount = static_cast<uint32_t>(indices.size());
-		hasIndexBuffer = indexCount > 0;
-
-		if (!hasIndexBuffer)
-			return;
-
-		uint32_t indexSize = sizeof(indices[0]);
-		// NOTE host means cpu and device means gpu
-		// VK_BUFFER_USAGE_TRANSFER_SRC_BIT tell vulkan that the buffer we are creating is going to be used as the source location for our memroy transfer operation.
-		// VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT  staging buffer will need to be host visible
-		// VK_MEMORY_PROPERTY_HOST_COHERENT_BIT whenever we change data on the host side to automatically flush that data to the device side
-
-		VeBuffer stagingBuffer{
-			veDevice,
-			indexSize,
-			indexCount,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-		};
-
-		stagingBuffer.map();
-		stagingBuffer.writeToBuffer((void*)indices.data());
-
-
-		// VK_BUFFER_USAGE_TRANSFER_DST_BIT this will be the destination of transfering data from staging buffer.
-		// VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT the most optimal but it can be accessed only by a staging buffer.
-		indexBuffer = std::make_unique<VeBuffer>(
-			veDevice,
-			indexSize,
-			indexCount,
-			VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-		);
-
-		veDevice.copyBuffer(stagingBuffer.getBuffer(), indexBuffer->getBuffer(), stagingBuffer.getBufferSize());
+		// centered on the bounds, not minimal but good enough for culling
+		glm::vec3 minPosition = vertices[0].position;
+		glm::vec3 maxPosition = vertices[0].position;
+		for (const Vertex& vertex : vertices)
+		{
+			minPosition = glm::min(minPosition, vertex.position);
+			maxPosition = glm::max(maxPosition, vertex.position);
+		}
+		const glm::vec3 center = (minPosition + maxPosition) * 0.5f;
+		float radius = 0.f;
+		for (const Vertex& vertex : vertices)
+			radius = glm::max(radius, glm::length(vertex.position - center));
+		boundingSphere = glm::vec4(center, radius);
 	}
 
 	std::vector<VkVertexInputBindingDescription> VeModel::Vertex::getBindingDescriptions()
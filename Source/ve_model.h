@@ -1,7 +1,7 @@
 #pragma once
 
-#include "ve_buffer.h"
 #include "ve_device.h"
+#include "ve_mesh_buffer.h"
 
 // libs
 #include <glm/glm.hpp>
@@ -49,20 +49,22 @@ namespace ve
 
 		static std::unique_ptr<VeModel> createModelFromFile(VeDevice& device, const std::string& filepath);
 
+		// binds the device's mesh buffer, which holds every model
 		void bind(VkCommandBuffer commandBuffer);
-		void draw(VkCommandBuffer commandBuffer);
+		// instances are numbered from firstInstance, which is where gl_InstanceIndex starts
+		void draw(VkCommandBuffer commandBuffer, uint32_t instanceCount = 1, uint32_t firstInstance = 0);
 
-	private:
-		void createVertexBuffers(const std::vector<Vertex>& vertices);
-		void createIndexBuffers(const std::vector<uint32_t>& indices);
+		// the model's part of the device's mesh buffer, every model is drawn indexed
+		const VeMeshBuffer::Range& getMeshRange() const { return meshRange; }
+		// sphere around every vertex in model space, xyz is the center and w the radius
+		glm::vec4 getBoundingSphere() const { return boundingSphere; }
 
-		VeDevice& veDevice;
+	private:
+		void computeBoundingSphere(const std::vector<Vertex>& vertices);
 
-		std::unique_ptr<VeBuffer> vertexBuffer;
-		uint32_t vertexCount;
+		VeMeshBuffer& meshBuffer;
+		VeMeshBuffer::Range meshRange;
 
-		bool hasIndexBuffer;
-		std::unique_ptr<VeBuffer> indexBuffer;
-		uint32_t indexCount;
+		glm::vec4 boundingSphere{ 0.f };
 	};
 }
\ No newline at end of file
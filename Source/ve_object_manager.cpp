@@ -1,29 +1,66 @@
 #include "ve_object_manager.h"
+#include "ve_scene_snapshot.h"
+#include "ve_texture_table.h"
 
 // std
-#include <numeric>
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
 
 namespace ve
 {
     
+	// element of the object storage buffers, laid out like ObjectData in simple_shader.vert
 	struct ObjectBufferData {
 		glm::mat4 modelMatrix{ 1.f };
 		glm::mat4 normalMatrix{ 1.f };
 	};
 
-	VeObjectManager::VeObjectManager(VeDevice& device) : EntityManager(VeObjectManager::MAX_OBJECTS)
+	// snapshot section of each saved component type
+	enum SnapshotSectionID : uint32_t
+	{
+		SNAPSHOT_TRANSFORM = 1,
+		SNAPSHOT_TAG = 2,
+		SNAPSHOT_POINT_LIGHT = 3,
+		SNAPSHOT_RENDERER = 4,
+		SNAPSHOT_HIERARCHY = 5,
+		SNAPSHOT_MOBILITY = 6,
+	};
+
+	// tag as it is stored in a snapshot, the layout TagComponent had before names were interned
+	struct TagSnapshot
+	{
+		char name[32];
+		uint32_t tags;
+	};
+
+	// renderer as it is stored in a snapshot, assets are referenced by id
+	struct RendererSnapshot
+	{
+		AssetID model;
+		AssetID diffuseMap;
+	};
+
+	VeObjectManager::VeObjectManager(VeDevice& device, VeJobSystem& jobSystem)
+		: SceneEntityManager(VeObjectManager::INITIAL_OBJECT_CAPACITY), veDevice(device), veJobSystem(jobSystem)
 	{
 		initEntityManager();
-		initBuffer(device);
-		textureDefault = std::make_shared<VeTexture>(device, "content/textures/missing.png");
+		setDestroyHook([this](entity_t entity) { cleanupObject(entity); });
+		for (int i = 0; i < objectBuffers.size(); i++)
+			createObjectBuffer(i, VeObjectManager::INITIAL_OBJECT_CAPACITY);
+		VeTextureTable* textureTable = device.getTextureTable();
+		if (!textureTable)
+			throw std::runtime_error("failed to create object manager, the device has no texture table!");
+		textureDefault = textureTable->getDefaultTexture();
+		registerTexture(VeTextureTable::DEFAULT_TEXTURE_PATH, textureDefault);
 	}
 
 	entity_t VeObjectManager::createObject()
 	{
-		assert(capacity() <= VeObjectManager::MAX_OBJECTS && "Adding more object than the max objects allowed.");
 		entity_t entity = createEntity();
 		AddComponent<TransformComponent>(entity);
 		AddComponent<TagComponent>(entity);
+		AddComponent<WorldTransformComponent>(entity);
 		return entity;
 	}
 
@@ -36,6 +73,34 @@ namespace ve
 		return entity;
 	}
 
+	ScenePrefab VeObjectManager::makeMeshPrefab(std::shared_ptr<VeModel> model, std::shared_ptr<VeTexture> diffuseMap /*= nullptr*/)
+	{
+		if (!diffuseMap)
+			diffuseMap = textureDefault;
+		ScenePrefab prefab;
+		prefab.add<TransformComponent>()
+			.add<TagComponent>()
+			.add<WorldTransformComponent>()
+			.add<RendererComponent>({ model, diffuseMap });
+		return prefab;
+	}
+
+	std::span<const entity_t> VeObjectManager::instantiate(const ScenePrefab& prefab, int32_t count)
+	{
+		std::span<const entity_t> entities = SceneEntityManager::instantiate(prefab, count);
+		if (entities.empty())
+			return entities;
+
+		const entity_t first = entities.front();
+		assert((count == 1 || !HasComponent<TagComponent>(first) || ReadComponent<TagComponent>(first).name == NO_NAME)
+			&& "Names are unique, a prefab instantiated more than once can't carry one.");
+		if (HasComponent<TagComponent>(first) && ReadComponent<TagComponent>(first).name != NO_NAME)
+			nameIndex[ReadComponent<TagComponent>(first).name] = first;
+		if (HasComponent<MobilityComponent>(first) && ReadComponent<MobilityComponent>(first).mobility != Mobility::Movable)
+			staticsDirty = true;
+		return entities;
+	}
+
 	entity_t VeObjectManager::createPointLight(float intensity /*= 10.f*/, float radius /*= 0.1f*/, glm::vec3 color /*= glm::vec3(1.0f)*/)
 	{
 		entity_t entity = createObject();
@@ -44,46 +109,515 @@ namespace ve
 		return entity;
 	}
 
+	void VeObjectManager::destroyObject(entity_t entity)
+	{
+		destroyEntity(entity);
+	}
+
+	void VeObjectManager::cleanupObject(entity_t entity)
+	{
+		if (HasComponent<HierarchyComponent>(entity))
+		{
+			// destroying a child unlinks it, so the first child moves on each time
+			for (entity_t child = ReadComponent<HierarchyComponent>(entity).firstChild; child != -1;
+				child = ReadComponent<HierarchyComponent>(entity).firstChild)
+			{
+				destroyEntity(child);
+			}
+			detachFromParent(entity);
+		}
+		if (HasComponent<TagComponent>(entity))
+		{
+			auto it = nameIndex.find(ReadComponent<TagComponent>(entity).name);
+			if (it != nameIndex.end() && it->second == entity)
+				nameIndex.erase(it);
+		}
+		if (HasComponent<MobilityComponent>(entity) && ReadComponent<MobilityComponent>(entity).mobility != Mobility::Movable)
+			staticsDirty = true;
+	}
+
+	void VeObjectManager::setParent(entity_t child, entity_t parent)
+	{
+		assert(isValid(child) && (parent == -1 || isValid(parent)) && "Entity id is not valid.");
+		for (entity_t ancestor = parent; ancestor != -1;
+			ancestor = HasComponent<HierarchyComponent>(ancestor) ? ReadComponent<HierarchyComponent>(ancestor).parent : -1)
+		{
+			assert(ancestor != child && "An entity can't be parented to itself or to one of its descendants.");
+		}
+
+		if (!HasComponent<HierarchyComponent>(child))
+			AddComponent<HierarchyComponent>(child);
+		if (ReadComponent<HierarchyComponent>(child).parent == parent)
+			return;
+
+		detachFromParent(child);
+		if (parent == -1)
+		{
+			updateDepth(child, 0);
+			return;
+		}
+
+		if (!HasComponent<HierarchyComponent>(parent))
+			AddComponent<HierarchyComponent>(parent);
+		HierarchyComponent& parentNode = GetComponent<HierarchyComponent>(parent);
+		HierarchyComponent& childNode = GetComponent<HierarchyComponent>(child);
+		childNode.parent = parent;
+		childNode.nextSibling = parentNode.firstChild;
+		if (parentNode.firstChild != -1)
+			GetComponent<HierarchyComponent>(parentNode.firstChild).prevSibling = child;
+		parentNode.firstChild = child;
+		updateDepth(child, parentNode.depth + 1);
+	}
+
+	void VeObjectManager::setName(entity_t entity, std::string_view name)
+	{
+		assert(isValid(entity) && "Entity id is not valid.");
+		if (!HasComponent<TagComponent>(entity))
+			AddComponent<TagComponent>(entity);
+		TagComponent& tag = GetComponent<TagComponent>(entity);
+		nameIndex.erase(tag.name);
+		tag.name = NO_NAME;
+		if (name.empty())
+			return;
+
+		const NameID id = hashName(name);
+		auto [it, inserted] = names.try_emplace(id, name);
+		assert((inserted || it->second == name) && "An other name is already interned with this id.");
+		auto [indexed, unique] = nameIndex.try_emplace(id, entity);
+		assert(unique && "An other object already has this name.");
+		tag.name = id;
+	}
+
+	std::string_view VeObjectManager::getName(entity_t entity)
+	{
+		if (!HasComponent<TagComponent>(entity))
+			return {};
+		auto it = names.find(ReadComponent<TagComponent>(entity).name);
+		return it != names.end() ? std::string_view(it->second) : std::string_view();
+	}
+
+	entity_t VeObjectManager::findObject(std::string_view name)
+	{
+		// an other name may hash to the same id
+		const NameID id = hashName(name);
+		auto it = nameIndex.find(id);
+		if (it == nameIndex.end())
+			return -1;
+		auto interned = names.find(id);
+		return interned != names.end() && interned->second == name ? it->second : -1;
+	}
+
+	void VeObjectManager::addTags(entity_t entity, uint32_t tags)
+	{
+		if (!HasComponent<TagComponent>(entity))
+			AddComponent<TagComponent>(entity);
+		GetComponent<TagComponent>(entity).tags |= tags;
+	}
+
+	void VeObjectManager::removeTags(entity_t entity, uint32_t tags)
+	{
+		if (HasComponent<TagComponent>(entity))
+			GetComponent<TagComponent>(entity).tags &= ~tags;
+	}
+
+	void VeObjectManager::findTagged(uint32_t tags, std::vector<entity_t>& outEntities)
+	{
+		// tag components are 8 bytes, so this is a linear walk over a small dense array
+		outEntities.clear();
+		for (auto [entity, tag] : view<const TagComponent>())
+		{
+			if ((tag.tags & tags) == tags)
+				outEntities.push_back(entity);
+		}
+	}
+
+	void VeObjectManager::rebuildNameIndex()
+	{
+		nameIndex.clear();
+		for (auto [entity, tag] : view<const TagComponent>())
+		{
+			if (tag.name != NO_NAME)
+				nameIndex[tag.name] = entity;
+		}
+	}
+
+	void VeObjectManager::setMobility(entity_t entity, Mobility mobility)
+	{
+		assert(isValid(entity) && "Entity id is not valid.");
+		if (!HasComponent<MobilityComponent>(entity))
+			AddComponent<MobilityComponent>(entity);
+		// marking the change makes the transform system sort its static entities out again
+		GetComponent<MobilityComponent>(entity).mobility = mobility;
+		staticsDirty = true;
+	}
+
+	void VeObjectManager::detachFromParent(entity_t entity)
+	{
+		// roots stay untouched, flagging them would make the transform system sort everything again
+		if (ReadComponent<HierarchyComponent>(entity).parent == -1)
+			return;
+
+		HierarchyComponent& node = GetComponent<HierarchyComponent>(entity);
+		if (node.prevSibling != -1)
+			GetComponent<HierarchyComponent>(node.prevSibling).nextSibling = node.nextSibling;
+		else
+			GetComponent<HierarchyComponent>(node.parent).firstChild = node.nextSibling;
+		if (node.nextSibling != -1)
+			GetComponent<HierarchyComponent>(node.nextSibling).prevSibling = node.prevSibling;
+		node.parent = -1;
+		node.nextSibling = -1;
+		node.prevSibling = -1;
+	}
+
+	void VeObjectManager::updateDepth(entity_t entity, uint32_t depth)
+	{
+		HierarchyComponent& node = GetComponent<HierarchyComponent>(entity);
+		node.depth = depth;
+		for (entity_t child = node.firstChild; child != -1; child = ReadComponent<HierarchyComponent>(child).nextSibling)
+			updateDepth(child, depth + 1);
+	}
+
+	AssetID VeObjectManager::getAssetID(const std::string& name)
+	{
+		return hashName(name);
+	}
+
+	AssetID VeObjectManager::registerModel(const std::string& name, std::shared_ptr<VeModel> model)
+	{
+		const AssetID id = getAssetID(name);
+		auto [it, inserted] = models.try_emplace(id, model);
+		assert((inserted || it->second == model) && "An other model is already registered with this id.");
+		modelIDs[model.get()] = id;
+		return id;
+	}
+
+	AssetID VeObjectManager::registerTexture(const std::string& name, std::shared_ptr<VeTexture> texture)
+	{
+		const AssetID id = getAssetID(name);
+		auto [it, inserted] = textures.try_emplace(id, texture);
+		assert((inserted || it->second == texture) && "An other texture is already registered with this id.");
+		textureIDs[texture.get()] = id;
+		return id;
+	}
+
+	std::shared_ptr<VeModel> VeObjectManager::findModel(AssetID id) const
+	{
+		auto it = models.find(id);
+		return it != models.end() ? it->second : nullptr;
+	}
+
+	std::shared_ptr<VeTexture> VeObjectManager::findTexture(AssetID id) const
+	{
+		auto it = textures.find(id);
+		return it != textures.end() ? it->second : nullptr;
+	}
+
+	void VeObjectManager::saveSnapshot(const std::string& filepath)
+	{
+		VeSnapshotWriter writer(*this);
+		writer.addPool<TransformComponent>(SNAPSHOT_TRANSFORM);
+		writer.addPool<TagSnapshot, TagComponent>(SNAPSHOT_TAG, [this](const TagComponent& tag)
+			{
+				TagSnapshot stored{};
+				stored.tags = tag.tags;
+				auto it = names.find(tag.name);
+				if (it != names.end())
+				{
+					if (it->second.size() >= sizeof(stored.name))
+						throw std::runtime_error("object name is too long to be saved: " + it->second);
+					it->second.copy(stored.name, it->second.size());
+				}
+				return stored;
+			});
+		writer.addPool<PointLightComponent>(SNAPSHOT_POINT_LIGHT);
+		writer.addPool<HierarchyComponent>(SNAPSHOT_HIERARCHY);
+		writer.addPool<MobilityComponent>(SNAPSHOT_MOBILITY);
+		writer.addPool<RendererSnapshot, RendererComponent>(SNAPSHOT_RENDERER, [this](const RendererComponent& renderer)
+			{
+				auto model = modelIDs.find(renderer.model.get());
+				auto texture = textureIDs.find(renderer.diffuseMap.get());
+				if (model == modelIDs.end() || texture == textureIDs.end())
+					throw std::runtime_error("renderer references an asset that was not registered!");
+				return RendererSnapshot{ model->second, texture->second };
+			});
+		writer.save(filepath);
+	}
+
+	void VeObjectManager::loadSnapshot(const std::string& filepath)
+	{
+		VeSnapshotReader reader(filepath);
+		reader.restoreEntities(*this);
+		reader.readPool<TransformComponent>(*this, SNAPSHOT_TRANSFORM);
+		reader.readPool<TagSnapshot, TagComponent>(*this, SNAPSHOT_TAG, [this](const TagSnapshot& stored)
+			{
+				const std::string_view name(stored.name, std::find(stored.name, std::end(stored.name), '\0') - stored.name);
+				TagComponent tag{ NO_NAME, stored.tags };
+				if (!name.empty())
+				{
+					tag.name = hashName(name);
+					names.try_emplace(tag.name, name);
+				}
+				return tag;
+			});
+		rebuildNameIndex();
+		reader.readPool<PointLightComponent>(*this, SNAPSHOT_POINT_LIGHT);
+		reader.readPool<HierarchyComponent>(*this, SNAPSHOT_HIERARCHY);
+		reader.readPool<MobilityComponent>(*this, SNAPSHOT_MOBILITY);
+		reader.readPool<RendererSnapshot, RendererComponent>(*this, SNAPSHOT_RENDERER, [this](const RendererSnapshot& stored)
+			{
+				RendererComponent renderer{ findModel(stored.model), findTexture(stored.diffuseMap) };
+				if (!renderer.model || !renderer.diffuseMap)
+					throw std::runtime_error("snapshot references an asset that is not registered!");
+				return renderer;
+			});
+
+		// world transforms aren't stored, the transform system recomputes them on its next update
+		for (entity_t entity : getEntities<TransformComponent>())
+			AddComponent<WorldTransformComponent>(entity);
+		staticsDirty = true;
+	}
+
 	void VeObjectManager::initEntityManager()
 	{
-		registerComponent<TransformComponent>(100);
-		registerComponent<TagComponent>(100);
-		registerComponent<PointLightComponent>(20);
-		registerComponent<RendererComponent>(20);
+		registerComponent<TransformComponent>(VeObjectManager::INITIAL_OBJECT_CAPACITY);
+		registerComponent<TagComponent>(VeObjectManager::INITIAL_OBJECT_CAPACITY);
+		registerComponent<PointLightComponent>();
+		registerComponent<RendererComponent>(VeObjectManager::INITIAL_OBJECT_CAPACITY);
+		registerComponent<HierarchyComponent>();
+		registerComponent<WorldTransformComponent>(VeObjectManager::INITIAL_OBJECT_CAPACITY);
+		registerComponent<MobilityComponent>();
+	}
+
+	void VeObjectManager::createObjectBuffer(int frameIndex, uint32_t instanceCount)
+	{
+		objectBuffers[frameIndex] = std::make_unique<VeBuffer>(
+			veDevice,
+			sizeof(ObjectBufferData),
+			instanceCount,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+		objectBuffers[frameIndex]->map();
+		objectBufferVersion++;
+	}
+
+	VkDescriptorBufferInfo VeObjectManager::getObjectBufferInfo(int frameIndex) const
+	{
+		return objectBuffers[frameIndex]->descriptorInfo();
 	}
 
-	void VeObjectManager::initBuffer(VeDevice& device)
+	VkDescriptorBufferInfo VeObjectManager::getStaticObjectBufferInfo() const
 	{
-		// including nonCoherentAtomSize allows us to flush a specific index at once
-		int alignment = std::lcm(
-			device.properties.limits.nonCoherentAtomSize,
-			device.properties.limits.minUniformBufferOffsetAlignment);
-		for (int i = 0; i < uboBuffers.size(); i++) {
-			uboBuffers[i] = std::make_unique<VeBuffer>(
-				device,
+		if (!staticObjectBuffer)
+			return VkDescriptorBufferInfo{ VK_NULL_HANDLE, 0, VK_WHOLE_SIZE };
+		return staticObjectBuffer->descriptorInfo();
+	}
+
+	void VeObjectManager::updateStaticBuffer(VkCommandBuffer commandBuffer, int frameIndex)
+	{
+		// the frame that retired it and every frame before it have finished
+		retiredStaticBuffers[frameIndex].reset();
+		if (staticsDirty)
+			bakeStaticObjects(commandBuffer, frameIndex);
+	}
+
+	void VeObjectManager::bakeStaticObjects(VkCommandBuffer commandBuffer, int frameIndex)
+	{
+		staticsDirty = false;
+		objectBufferVersion++;
+		std::vector<int32_t> previousSlots = std::move(staticSlots);
+		staticSlots.assign(capacity(), -1);
+		int32_t count = 0;
+		for (entity_t entity : getEntities<MobilityComponent>())
+		{
+			if (ReadComponent<MobilityComponent>(entity).mobility != Mobility::Movable && HasComponent<WorldTransformComponent>(entity))
+				staticSlots[entity] = count++;
+		}
+
+		// objects that became movable were never written to the per frame buffers, or only long ago.
+		// updateBuffer already wrote this frame's buffer, so they're written to it right away
+		bool becameMovable = false;
+		for (std::vector<uint64_t>& frameBits : pendingUploads)
+		{
+			frameBits.resize((capacity() + 63) / 64, 0);
+			for (entity_t entity = 0; entity < static_cast<entity_t>(previousSlots.size()) && entity < capacity(); entity++)
+			{
+				if (previousSlots[entity] != -1 && staticSlots[entity] == -1)
+				{
+					frameBits[entity >> 6] |= uint64_t(1) << (entity & 63);
+					becameMovable = true;
+				}
+			}
+		}
+		if (becameMovable)
+			writePendingObjects(frameIndex);
+
+		if (count == 0)
+		{
+			// frames still in flight may read the old buffer
+			retiredStaticBuffers[frameIndex] = std::move(staticObjectBuffer);
+			return;
+		}
+
+		// the frame's previous submission was the last one to read its staging buffer
+		std::unique_ptr<VeBuffer>& stagingBuffer = staticStagingBuffers[frameIndex];
+		if (!stagingBuffer || stagingBuffer->getInstanceCount() < static_cast<uint32_t>(count))
+		{
+			stagingBuffer = std::make_unique<VeBuffer>(
+				veDevice,
 				sizeof(ObjectBufferData),
-				VeObjectManager::MAX_OBJECTS,
-				VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
-				alignment);
-			uboBuffers[i]->map();
+				std::bit_ceil(static_cast<uint32_t>(count)),
+				VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			stagingBuffer->map();
 		}
+		for (entity_t entity : getEntities<MobilityComponent>())
+		{
+			if (staticSlots[entity] == -1)
+				continue;
+			const WorldTransformComponent& world = ReadComponent<WorldTransformComponent>(entity);
+			ObjectBufferData data{};
+			data.modelMatrix = world.matrix;
+			data.normalMatrix = world.normalMatrix;
+			stagingBuffer->writeToIndex(&data, staticSlots[entity]);
+		}
+
+		if (!staticObjectBuffer || staticObjectBuffer->getInstanceCount() < static_cast<uint32_t>(count))
+		{
+			// frames still in flight may read the old buffer
+			retiredStaticBuffers[frameIndex] = std::move(staticObjectBuffer);
+			staticObjectBuffer = std::make_unique<VeBuffer>(
+				veDevice,
+				sizeof(ObjectBufferData),
+				std::bit_ceil(static_cast<uint32_t>(count)),
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		}
+
+		// the copy waits for earlier frames to stop reading the buffer, and this frame's shaders wait for the copy
+		VkBufferMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.buffer = staticObjectBuffer->getBuffer();
+		barrier.offset = 0;
+		barrier.size = VK_WHOLE_SIZE;
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+		VkBufferCopy copyRegion{};
+		copyRegion.size = stagingBuffer->getAlignmentSize() * count;
+		vkCmdCopyBuffer(commandBuffer, stagingBuffer->getBuffer(), staticObjectBuffer->getBuffer(), 1, &copyRegion);
+
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0, 0, nullptr, 1, &barrier, 0, nullptr);
+	}
+
+	void VeObjectManager::reserveObjectBuffer(int frameIndex)
+	{
+		// the buffer is indexed by entity id, so it has to cover every id handed out so far
+		if (capacity() <= static_cast<entity_t>(objectBuffers[frameIndex]->getInstanceCount()))
+			return;
+
+		uint32_t instanceCount = objectBuffers[frameIndex]->getInstanceCount();
+		while (instanceCount < static_cast<uint32_t>(capacity()))
+			instanceCount *= 2;
+		createObjectBuffer(frameIndex, instanceCount);
+
+		// the new buffer starts empty, so everything has to be written again
+		pendingUploads[frameIndex].assign((capacity() + 63) / 64, ~uint64_t(0));
 	}
 
 	void VeObjectManager::updateBuffer(int frameIndex)
 	{
-		// copy model matrix and normal matrix for each gameObj into
-		// buffer for this frame
-		for (entity_t entity : getEntities<TransformComponent>())
+		assert(capacity() <= static_cast<entity_t>(objectBuffers[frameIndex]->getInstanceCount())
+			&& "The object buffer has to be reserved before the systems run.");
+
+		// world transforms changed since the last update have to reach every copy of the buffer,
+		// a baked object that moved gets baked again instead, by updateStaticBuffer on the main thread
+		takeChanges<WorldTransformComponent>(changedTransforms);
+		for (size_t word = 0; word < changedTransforms.size(); word++)
 		{
-			TransformComponent& transComp = GetComponent<TransformComponent>(entity);
-			ObjectBufferData data{};
-			data.modelMatrix = transComp.mat4();
-			data.normalMatrix = transComp.normalMatrix();
-			uboBuffers[frameIndex]->writeToIndex(&data, entity);
+			for (uint64_t bits = changedTransforms[word]; bits; bits &= bits - 1)
+			{
+				const entity_t entity = static_cast<entity_t>(word * 64) + std::countr_zero(bits);
+				if (entity < static_cast<entity_t>(staticSlots.size()) && staticSlots[entity] != -1)
+				{
+					changedTransforms[word] &= ~(uint64_t(1) << (entity & 63));
+					staticsDirty = true;
+				}
+			}
+		}
+		for (std::vector<uint64_t>& frameBits : pendingUploads)
+		{
+			frameBits.resize(changedTransforms.size(), 0);
+			for (size_t word = 0; word < changedTransforms.size(); word++)
+				frameBits[word] |= changedTransforms[word];
 		}
-		uboBuffers[frameIndex]->flush();
+		writePendingObjects(frameIndex);
+	}
+
+	void VeObjectManager::writePendingObjects(int frameIndex)
+	{
+		std::vector<uint64_t>& pending = pendingUploads[frameIndex];
+
+		// copy model matrix and normal matrix of each changed gameObj into
+		// buffer for this frame, every entity writes its own slot so words are packed in parallel
+		VeBuffer& objectBuffer = *objectBuffers[frameIndex];
+		// entities created by the systems' commands aren't covered until the buffer is reserved again,
+		// which writes everything
+		const entity_t numEntities = std::min(capacity(), static_cast<entity_t>(objectBuffer.getInstanceCount()));
+		veJobSystem.parallelFor(static_cast<int32_t>(pending.size()), 64, [&](int32_t firstWord, int32_t lastWord)
+		{
+			for (int32_t word = firstWord; word < lastWord; word++)
+			{
+				for (uint64_t bits = pending[word]; bits; bits &= bits - 1)
+				{
+					const entity_t entity = word * 64 + std::countr_zero(bits);
+					if (entity >= numEntities || !HasComponent<WorldTransformComponent>(entity))
+						continue;
 
+					const WorldTransformComponent& world = ReadComponent<WorldTransformComponent>(entity);
+					ObjectBufferData data{};
+					data.modelMatrix = world.matrix;
+					data.normalMatrix = world.normalMatrix;
+					objectBuffer.writeToIndex(&data, entity);
+				}
+			}
+		});
+
+		// flush runs of consecutive written entities as single ranges
+		entity_t runStart = -1;
+		entity_t runEnd = -1;
+		for (size_t word = 0; word < pending.size(); word++)
+		{
+			for (uint64_t bits = pending[word]; bits; bits &= bits - 1)
+			{
+				const entity_t entity = static_cast<entity_t>(word * 64) + std::countr_zero(bits);
+				if (entity >= numEntities || !HasComponent<WorldTransformComponent>(entity))
+					continue;
+
+				if (entity != runEnd)
+				{
+					if (runStart != -1)
+						objectBuffer.flushIndexRange(runStart, runEnd - runStart);
+					runStart = entity;
+				}
+				runEnd = entity + 1;
+			}
+			pending[word] = 0;
+		}
+		if (runStart != -1)
+			objectBuffer.flushIndexRange(runStart, runEnd - runStart);
 	}
 
 }
\ No newline at end of file
@@ -1,18 +1,31 @@
 #pragma once
-#include "ve_ecs.h"
+#include "ve_ecs_archetype.h"
 #include "ve_components.h"
 #include "ve_buffer.h"
+#include "ve_job_system.h"
+#include "ve_model.h"
 #include "ve_swap_chain.h"
+#include "ve_texture.h"
+
+// std
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 
 namespace ve
 {
-    class VeObjectManager : public EntityManager
+	// stable id of an asset, the hash of the name it was registered with
+	typedef uint32_t AssetID;
+
+    class VeObjectManager : public SceneEntityManager
     {
 	public:
-		// max number of objects we can create 
-		static constexpr int MAX_OBJECTS = 1000;
+		// number of objects the entity manager and object buffers are sized for up front,
+		// both grow past it on demand
+		static constexpr int INITIAL_OBJECT_CAPACITY = 1024;
 
-		VeObjectManager(VeDevice& device);
+		VeObjectManager(VeDevice& device, VeJobSystem& jobSystem);
 		VeObjectManager(const VeObjectManager&) = delete;
 		VeObjectManager& operator=(const VeObjectManager&) = delete;
 		VeObjectManager(VeObjectManager&&) = delete;
@@ -21,16 +34,106 @@ namespace ve
 		entity_t createObject();
 		entity_t createMeshObject(std::shared_ptr<VeModel> model, std::shared_ptr<VeTexture> diffuseMap = nullptr);
 		entity_t createPointLight(float intensity = 10.f, float radius = 0.1f, glm::vec3 color = glm::vec3(1.0f));
+		// the components createMeshObject gives an entity, to spawn many of them at once with instantiate
+		ScenePrefab makeMeshPrefab(std::shared_ptr<VeModel> model, std::shared_ptr<VeTexture> diffuseMap = nullptr);
+		// creates count objects in one pass, the ids stay valid until the next object is created
+		std::span<const entity_t> instantiate(const ScenePrefab& prefab, int32_t count);
+		// destroys the entity together with all of its descendants, destroying it through
+		// destroyEntity or the command buffer does the same
+		void destroyObject(entity_t entity);
+
+		// attaches child under parent, its transform becomes relative to the parent. -1 detaches it
+		void setParent(entity_t child, entity_t parent);
+
+		// names are interned and unique, finding an object by name is a hash lookup. an empty name removes it
+		void setName(entity_t entity, std::string_view name);
+		std::string_view getName(entity_t entity);
+		// -1 if no object has this name
+		entity_t findObject(std::string_view name);
+
+		void addTags(entity_t entity, uint32_t tags);
+		void removeTags(entity_t entity, uint32_t tags);
+		// every object that has all of the tags
+		void findTagged(uint32_t tags, std::vector<entity_t>& outEntities);
+
+		// static and stationary objects are baked into a device local buffer that updateBuffer doesn't
+		// touch, moving a stationary object bakes them all again
+		void setMobility(entity_t entity, Mobility mobility);
 
-		VkDescriptorBufferInfo getBufferInfoForGameObject(int frameIndex, entity_t entity) const {
-			return uboBuffers[frameIndex]->descriptorInfoForIndex(entity);
+		// assets have to be registered under a stable name before renderers using them can be saved or loaded
+		static AssetID getAssetID(const std::string& name);
+		AssetID registerModel(const std::string& name, std::shared_ptr<VeModel> model);
+		AssetID registerTexture(const std::string& name, std::shared_ptr<VeTexture> texture);
+		std::shared_ptr<VeModel> findModel(AssetID id) const;
+		std::shared_ptr<VeTexture> findTexture(AssetID id) const;
+
+		// binary scene snapshot of every entity with its transform, tag, point light and renderer.
+		// loading replaces the whole scene
+		void saveSnapshot(const std::string& filepath);
+		void loadSnapshot(const std::string& filepath);
+
+		// objects are read from storage buffers of tightly packed model and normal matrices.
+		// movable objects live in the frame's buffer, baked ones in the static buffer
+		VkDescriptorBufferInfo getObjectBufferInfo(int frameIndex) const;
+		// the buffer is VK_NULL_HANDLE while nothing is baked
+		VkDescriptorBufferInfo getStaticObjectBufferInfo() const;
+		bool isStaticObject(entity_t entity) const {
+			return entity < static_cast<entity_t>(staticSlots.size()) && staticSlots[entity] != -1;
+		}
+		// index of the object in its buffer, with STATIC_OBJECT_BIT set when it's in the static one
+		static constexpr uint32_t STATIC_OBJECT_BIT = 0x80000000u;
+		uint32_t getObjectReference(entity_t entity) const {
+			return isStaticObject(entity) ? STATIC_OBJECT_BIT | static_cast<uint32_t>(staticSlots[entity]) : static_cast<uint32_t>(entity);
 		}
+		// replaces the frame's object buffer by a larger one when entity ids outgrew it. call it on the
+		// main thread before the systems run, the gpu finished the last frame that used the buffer then
+		void reserveObjectBuffer(int frameIndex);
+		// runs as a scheduler system and only writes into the mapped buffer,
+		// baked objects that moved are only flagged to be baked again
 		void updateBuffer(int frameIndex);
+		// bakes the static objects again when they changed, recording the upload into the frame's
+		// command buffer. call it on the main thread after the systems ran, outside the render pass
+		void updateStaticBuffer(VkCommandBuffer commandBuffer, int frameIndex);
+		// changes whenever an object buffer is replaced, descriptors built from
+		// getObjectBufferInfo and getStaticObjectBufferInfo have to be written again then
+		uint32_t getObjectBufferVersion() const { return objectBufferVersion; }
 	private:
 		void initEntityManager();
-		void initBuffer(VeDevice& device);
+		// destroy hook, keeps the hierarchy links, the name index and the baked objects consistent
+		void cleanupObject(entity_t entity);
+		void detachFromParent(entity_t entity);
+		void rebuildNameIndex();
+		void updateDepth(entity_t entity, uint32_t depth);
+		void createObjectBuffer(int frameIndex, uint32_t instanceCount);
+		void bakeStaticObjects(VkCommandBuffer commandBuffer, int frameIndex);
+		// writes the entities set in the frame's pending bits to its object buffer
+		void writePendingObjects(int frameIndex);
 
-		std::vector<std::unique_ptr<VeBuffer>> uboBuffers{ VeSwapChain::MAX_FRAMES_IN_FLIGHT };
+		VeDevice& veDevice;
+		VeJobSystem& veJobSystem;
+		std::vector<std::unique_ptr<VeBuffer>> objectBuffers{ VeSwapChain::MAX_FRAMES_IN_FLIGHT };
+		// one bit per entity whose transform changed since the frame's buffer was last written
+		std::vector<std::vector<uint64_t>> pendingUploads{ VeSwapChain::MAX_FRAMES_IN_FLIGHT };
+		std::vector<uint64_t> changedTransforms;
+		// matrices of the non movable objects, shared by every frame
+		std::unique_ptr<VeBuffer> staticObjectBuffer;
+		// each frame uploads its bake through its own staging buffer
+		std::vector<std::unique_ptr<VeBuffer>> staticStagingBuffers{ VeSwapChain::MAX_FRAMES_IN_FLIGHT };
+		// replaced static buffers, kept until the frame that replaced them comes around again
+		std::vector<std::unique_ptr<VeBuffer>> retiredStaticBuffers{ VeSwapChain::MAX_FRAMES_IN_FLIGHT };
+		// slot of each entity in staticObjectBuffer, -1 if it isn't baked
+		std::vector<int32_t> staticSlots;
+		bool staticsDirty = false;
+		uint32_t objectBufferVersion = 0;
 		std::shared_ptr<VeTexture> textureDefault;
+
+		// interned strings are kept for the lifetime of the manager
+		std::unordered_map<NameID, std::string> names;
+		std::unordered_map<NameID, entity_t> nameIndex;
+
+		std::unordered_map<AssetID, std::shared_ptr<VeModel>> models;
+		std::unordered_map<AssetID, std::shared_ptr<VeTexture>> textures;
+		std::unordered_map<const VeModel*, AssetID> modelIDs;
+		std::unordered_map<const VeTexture*, AssetID> textureIDs;
     };
 }
\ No newline at end of file
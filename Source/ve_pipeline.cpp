@@ -233,4 +233,39 @@ namespace ve
         configInfo.colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
 	}
 
+
+    VeComputePipeline::VeComputePipeline(VeDevice& device, VkPipelineLayout pipelineLayout, const std::string& compFilePath)
+        : veDevice(device)
+    {
+        assert(pipelineLayout != VK_NULL_HANDLE && "Cannot create compute pipeline:: no pipelineLayout provided");
+
+        std::vector<char> compCode = VePipeline::readFile(compFilePath);
+        VkShaderModuleCreateInfo moduleInfo{};
+        moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        moduleInfo.codeSize = compCode.size();
+        moduleInfo.pCode = reinterpret_cast<const uint32_t*>(compCode.data());
+        if (vkCreateShaderModule(veDevice.device(), &moduleInfo, nullptr, &compShaderModule) != VK_SUCCESS)
+            throw std::runtime_error("failed to create shader module.");
+
+        VkComputePipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = compShaderModule;
+        pipelineInfo.stage.pName = "main";
+        pipelineInfo.layout = pipelineLayout;
+        if (vkCreateComputePipelines(veDevice.device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &computePipeline) != VK_SUCCESS)
+            throw std::runtime_error("failed to create compute pipeline");
+    }
+
+    VeComputePipeline::~VeComputePipeline()
+    {
+        vkDestroyShaderModule(veDevice.device(), compShaderModule, nullptr);
+        vkDestroyPipeline(veDevice.device(), computePipeline, nullptr);
+    }
+
+    void VeComputePipeline::bind(VkCommandBuffer commandBuffer)
+    {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline);
+    }
 }
\ No newline at end of file
@@ -47,6 +47,8 @@ namespace ve
         static void defaultPipelineConfigInfo(PipelineConfigInfo& configInfo);
         static void enableAlphaBlending(PipelineConfigInfo& configInfo);
     private:
+        friend class VeComputePipeline;
+
         static std::vector<char> readFile(const std::string &filePath);
 
         void createGraphicsPipeline(
@@ -61,4 +63,20 @@ namespace ve
         VkShaderModule vertShaderModule;
         VkShaderModule fragShaderModule;
     };
+
+    // single compute shader stage, the layout is owned by the caller like for graphics pipelines
+    class VeComputePipeline
+    {
+    public:
+        VeComputePipeline(VeDevice& device, VkPipelineLayout pipelineLayout, const std::string& compFilePath);
+        ~VeComputePipeline();
+        VeComputePipeline(const VeComputePipeline&) = delete;
+        VeComputePipeline operator=(const VeComputePipeline&) = delete;
+
+        void bind(VkCommandBuffer commandBuffer);
+    private:
+        VeDevice& veDevice;
+        VkPipeline computePipeline;
+        VkShaderModule compShaderModule;
+    };
 }
\ No newline at end of file
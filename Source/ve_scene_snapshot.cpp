@@ -0,0 +1,183 @@
+#include "ve_scene_snapshot.h"
+
+// std
+#include <cstdio>
+#include <memory>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ve
+{
+#ifdef _WIN32
+	VeMappedFile::VeMappedFile(const std::string& filepath)
+	{
+		HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			throw std::runtime_error("failed to open file: " + filepath);
+		fileHandle = file;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+		{
+			CloseHandle(file);
+			throw std::runtime_error("failed to map empty file: " + filepath);
+		}
+		mappedSize = static_cast<size_t>(fileSize.QuadPart);
+
+		mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mappingHandle)
+		{
+			CloseHandle(file);
+			throw std::runtime_error("failed to map file: " + filepath);
+		}
+		mappedData = static_cast<const std::byte*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+		if (!mappedData)
+		{
+			CloseHandle(mappingHandle);
+			CloseHandle(file);
+			throw std::runtime_error("failed to map file: " + filepath);
+		}
+	}
+
+	VeMappedFile::~VeMappedFile()
+	{
+		UnmapViewOfFile(mappedData);
+		CloseHandle(mappingHandle);
+		CloseHandle(fileHandle);
+	}
+#else
+	VeMappedFile::VeMappedFile(const std::string& filepath)
+	{
+		int file = open(filepath.c_str(), O_RDONLY);
+		if (file == -1)
+			throw std::runtime_error("failed to open file: " + filepath);
+
+		struct stat fileStat;
+		if (fstat(file, &fileStat) == -1 || fileStat.st_size == 0)
+		{
+			close(file);
+			throw std::runtime_error("failed to map empty file: " + filepath);
+		}
+		mappedSize = static_cast<size_t>(fileStat.st_size);
+
+		void* mapping = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, file, 0);
+		// the mapping keeps its own reference to the file
+		close(file);
+		if (mapping == MAP_FAILED)
+			throw std::runtime_error("failed to map file: " + filepath);
+		madvise(mapping, mappedSize, MADV_SEQUENTIAL);
+		mappedData = static_cast<const std::byte*>(mapping);
+	}
+
+	VeMappedFile::~VeMappedFile()
+	{
+		munmap(const_cast<std::byte*>(mappedData), mappedSize);
+	}
+#endif
+
+	void snapshot::writeFile(const std::string& filepath, const std::vector<entity_t>& entities, entity_t availableEntity,
+		const std::vector<PendingSection>& sections)
+	{
+		// lay out every block first so the whole file is built in one allocation and written at once
+		Header header{};
+		header.magic = SNAPSHOT_MAGIC;
+		header.version = SNAPSHOT_VERSION;
+		header.entityCount = static_cast<int32_t>(entities.size());
+		header.availableEntity = availableEntity;
+		header.sectionCount = static_cast<uint32_t>(sections.size());
+
+		uint64_t offset = alignOffset(sizeof(Header) + sizeof(Section) * sections.size());
+		header.entityTableOffset = offset;
+		offset = alignOffset(offset + sizeof(entity_t) * entities.size());
+
+		std::vector<Section> table(sections.size());
+		for (size_t i = 0; i < sections.size(); i++)
+		{
+			table[i] = { sections[i].id, sections[i].elementSize, sections[i].count, 0, 0, 0 };
+			table[i].ownersOffset = offset;
+			offset = alignOffset(offset + sizeof(entity_t) * sections[i].count);
+			table[i].dataOffset = offset;
+			offset = alignOffset(offset + uint64_t(sections[i].elementSize) * sections[i].count);
+		}
+
+		std::unique_ptr<std::byte[]> blob(new std::byte[offset]());
+		std::memcpy(blob.get(), &header, sizeof(Header));
+		std::memcpy(blob.get() + sizeof(Header), table.data(), sizeof(Section) * table.size());
+		std::memcpy(blob.get() + header.entityTableOffset, entities.data(), sizeof(entity_t) * entities.size());
+		for (size_t i = 0; i < sections.size(); i++)
+			sections[i].write(blob.get() + table[i].ownersOffset, blob.get() + table[i].dataOffset);
+
+		FILE* file = std::fopen(filepath.c_str(), "wb");
+		if (!file)
+			throw std::runtime_error("failed to open snapshot for writing: " + filepath);
+		const size_t written = std::fwrite(blob.get(), 1, offset, file);
+		std::fclose(file);
+		if (written != offset)
+			throw std::runtime_error("failed to write snapshot: " + filepath);
+	}
+
+	VeSnapshotReader::VeSnapshotReader(const std::string& filepath) : file(filepath)
+	{
+		using namespace snapshot;
+		if (file.size() < sizeof(Header))
+			throw std::runtime_error("snapshot is truncated: " + filepath);
+
+		const Header& fileHeader = header();
+		if (fileHeader.magic != SNAPSHOT_MAGIC)
+			throw std::runtime_error("file is not a scene snapshot: " + filepath);
+		if (fileHeader.version != SNAPSHOT_VERSION)
+			throw std::runtime_error("unsupported snapshot version: " + filepath);
+
+		auto inBounds = [this](uint64_t offset, uint64_t bytes)
+		{
+			return offset % SNAPSHOT_ALIGNMENT == 0 && offset <= file.size() && bytes <= file.size() - offset;
+		};
+		if (fileHeader.entityCount < 0
+			|| fileHeader.availableEntity < -1 || fileHeader.availableEntity >= fileHeader.entityCount
+			|| sizeof(Section) * uint64_t(fileHeader.sectionCount) > file.size() - sizeof(Header)
+			|| !inBounds(fileHeader.entityTableOffset, sizeof(entity_t) * uint64_t(fileHeader.entityCount)))
+			throw std::runtime_error("snapshot header is corrupt: " + filepath);
+
+		// owners index straight into the entity slots, so they are checked once here instead of per access
+		const Section* sections = reinterpret_cast<const Section*>(file.data() + sizeof(Header));
+		for (uint32_t i = 0; i < fileHeader.sectionCount; i++)
+		{
+			const Section& section = sections[i];
+			if (section.count < 0
+				|| !inBounds(section.ownersOffset, sizeof(entity_t) * uint64_t(section.count))
+				|| !inBounds(section.dataOffset, uint64_t(section.elementSize) * section.count))
+				throw std::runtime_error("snapshot section is corrupt: " + filepath);
+
+			const entity_t* owners = ownersOf(section);
+			for (int32_t j = 0; j < section.count; j++)
+			{
+				if (owners[j] < 0 || owners[j] >= fileHeader.entityCount)
+					throw std::runtime_error("snapshot section references an invalid entity: " + filepath);
+			}
+		}
+	}
+
+	const snapshot::Section* VeSnapshotReader::findSection(uint32_t id, uint32_t elementSize) const
+	{
+		const snapshot::Section* sections = reinterpret_cast<const snapshot::Section*>(file.data() + sizeof(snapshot::Header));
+		for (uint32_t i = 0; i < header().sectionCount; i++)
+		{
+			if (sections[i].id != id)
+				continue;
+			if (sections[i].elementSize != elementSize)
+				throw std::runtime_error("snapshot section has a different component layout");
+			return &sections[i];
+		}
+		return nullptr;
+	}
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "ve_ecs.h"
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace ve
+{
+	// read only view of a whole file mapped into memory
+	class VeMappedFile
+	{
+	public:
+		VeMappedFile(const std::string& filepath);
+		~VeMappedFile();
+
+		VeMappedFile(const VeMappedFile&) = delete;
+		VeMappedFile& operator=(const VeMappedFile&) = delete;
+
+		const std::byte* data() const { return mappedData; }
+		size_t size() const { return mappedSize; }
+
+	private:
+		const std::byte* mappedData = nullptr;
+		size_t mappedSize = 0;
+#ifdef _WIN32
+		void* fileHandle = nullptr;
+		void* mappingHandle = nullptr;
+#endif
+	};
+
+	// binary snapshot of an entity manager. the file is
+	//   header | section table | entity table | per section: owners, components
+	// every block starts on a SNAPSHOT_ALIGNMENT boundary so it can be read straight out of the mapping.
+	// components are stored as raw bytes of the host, a file is only portable between hosts with the same layout
+	namespace snapshot
+	{
+		constexpr uint32_t SNAPSHOT_MAGIC = 0x4E534556; // "VESN"
+		constexpr uint32_t SNAPSHOT_VERSION = 1;
+		constexpr uint64_t SNAPSHOT_ALIGNMENT = 64;
+
+		struct Header
+		{
+			uint32_t magic;
+			uint32_t version;
+			int32_t entityCount;
+			entity_t availableEntity;
+			uint32_t sectionCount;
+			uint32_t reserved;
+			uint64_t entityTableOffset;
+		};
+
+		struct Section
+		{
+			uint32_t id;
+			uint32_t elementSize;
+			int32_t count;
+			uint32_t reserved;
+			uint64_t ownersOffset;
+			uint64_t dataOffset;
+		};
+
+		static_assert(sizeof(Header) == 32 && sizeof(Section) == 32, "Snapshot layout must not depend on padding.");
+
+		inline uint64_t alignOffset(uint64_t offset)
+		{
+			return (offset + SNAPSHOT_ALIGNMENT - 1) & ~(SNAPSHOT_ALIGNMENT - 1);
+		}
+
+		struct PendingSection
+		{
+			uint32_t id;
+			uint32_t elementSize;
+			int32_t count;
+			std::function<void(std::byte* owners, std::byte* data)> write;
+		};
+
+		// lays out the whole file and writes it at once, the part of saving that doesn't depend on the backend
+		void writeFile(const std::string& filepath, const std::vector<entity_t>& entities, entity_t availableEntity,
+			const std::vector<PendingSection>& sections);
+	}
+
+	// works with either entity manager backend, components are stored in the order of getEntities
+	template<typename Manager>
+	class VeSnapshotWriter
+	{
+	public:
+		VeSnapshotWriter(Manager& inManager) : manager(inManager) {}
+
+		// stores the components as is, component type has to be plain data
+		template<typename ComponentType>
+		void addPool(uint32_t id)
+		{
+			static_assert(std::is_trivially_copyable_v<ComponentType>, "Only trivially copyable components can be stored as raw bytes.");
+			const int32_t count = static_cast<int32_t>(manager.template getEntities<ComponentType>().size());
+			addSection(id, sizeof(ComponentType), count, [&manager = manager](std::byte* owners, std::byte* data)
+				{
+					const std::vector<entity_t>& entities = manager.template getEntities<ComponentType>();
+					std::memcpy(owners, entities.data(), sizeof(entity_t) * entities.size());
+					manager.template copyComponents<ComponentType>(reinterpret_cast<ComponentType*>(data));
+				});
+		}
+
+		// stores convert(component) for every component, for components that hold references
+		template<typename StoredType, typename ComponentType, typename Convert>
+		void addPool(uint32_t id, Convert convert)
+		{
+			static_assert(std::is_trivially_copyable_v<StoredType>, "Stored type has to be plain data.");
+			const int32_t count = static_cast<int32_t>(manager.template getEntities<ComponentType>().size());
+			addSection(id, sizeof(StoredType), count, [&manager = manager, convert](std::byte* owners, std::byte* data)
+				{
+					const std::vector<entity_t>& entities = manager.template getEntities<ComponentType>();
+					std::memcpy(owners, entities.data(), sizeof(entity_t) * entities.size());
+					for (size_t i = 0; i < entities.size(); i++)
+					{
+						const StoredType stored = convert(manager.template ReadComponent<ComponentType>(entities[i]));
+						std::memcpy(data + sizeof(StoredType) * i, &stored, sizeof(StoredType));
+					}
+				});
+		}
+
+		void save(const std::string& filepath)
+		{
+			snapshot::writeFile(filepath, manager.getEntityTable(), manager.getAvailableEntity(), sections);
+		}
+
+	private:
+		void addSection(uint32_t id, uint32_t elementSize, int32_t count, std::function<void(std::byte*, std::byte*)> write)
+		{
+			for (const snapshot::PendingSection& section : sections)
+				assert(section.id != id && "Snapshot section id is used twice.");
+			sections.push_back({ id, elementSize, count, std::move(write) });
+		}
+
+		Manager& manager;
+		std::vector<snapshot::PendingSection> sections;
+	};
+
+	class VeSnapshotReader
+	{
+	public:
+		// maps the file and validates the header and section bounds, throws when the file can't be used
+		VeSnapshotReader(const std::string& filepath);
+
+		// replaces every entity of the manager and empties its pools
+		template<typename Manager>
+		void restoreEntities(Manager& manager) const
+		{
+			manager.restoreEntities(reinterpret_cast<const entity_t*>(file.data() + header().entityTableOffset),
+				header().entityCount, header().availableEntity);
+		}
+
+		// bulk copies a stored pool, returns false when the snapshot has no such section
+		template<typename ComponentType, typename Manager>
+		bool readPool(Manager& manager, uint32_t id) const
+		{
+			const snapshot::Section* section = findSection(id, sizeof(ComponentType));
+			if (!section)
+				return false;
+			manager.template restoreComponents<ComponentType>(ownersOf(*section),
+				reinterpret_cast<const ComponentType*>(file.data() + section->dataOffset), section->count);
+			return true;
+		}
+
+		// adds convert(stored) to every stored owner, the counterpart of the converting addPool
+		template<typename StoredType, typename ComponentType, typename Manager, typename Convert>
+		bool readPool(Manager& manager, uint32_t id, Convert convert) const
+		{
+			const snapshot::Section* section = findSection(id, sizeof(StoredType));
+			if (!section)
+				return false;
+			const entity_t* owners = ownersOf(*section);
+			const std::byte* data = file.data() + section->dataOffset;
+			for (int32_t i = 0; i < section->count; i++)
+			{
+				StoredType stored;
+				std::memcpy(&stored, data + sizeof(StoredType) * i, sizeof(StoredType));
+				manager.template AddComponent<ComponentType>(owners[i]) = convert(stored);
+			}
+			return true;
+		}
+
+	private:
+		const snapshot::Header& header() const { return *reinterpret_cast<const snapshot::Header*>(file.data()); }
+		const snapshot::Section* findSection(uint32_t id, uint32_t elementSize) const;
+		const entity_t* ownersOf(const snapshot::Section& section) const
+		{
+			return reinterpret_cast<const entity_t*>(file.data() + section.ownersOffset);
+		}
+
+		VeMappedFile file;
+	};
+}
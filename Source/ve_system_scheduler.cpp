@@ -0,0 +1,84 @@
+#include "ve_system_scheduler.h"
+
+// std
+#include <algorithm>
+#include <stdexcept>
+
+namespace ve
+{
+	void VeSystemScheduler::addSystem(const std::string& name, const SystemAccess& access, SystemFunction function,
+		const std::vector<std::string>& after /*= {}*/)
+	{
+		System system{ name, access, std::move(function) };
+		for (const std::string& dependency : after)
+		{
+			auto found = std::find_if(systems.begin(), systems.end(), [&dependency](const System& other) { return other.name == dependency; });
+			if (found == systems.end())
+				throw std::runtime_error("failed to add system " + name + ", " + dependency + " isn't registered before it!");
+			system.dependencies.push_back(found - systems.begin());
+		}
+
+		for (size_t earlier = 0; earlier < systems.size(); earlier++)
+		{
+			if (systems[earlier].access.conflictsWith(access) && !dependsOn(system, earlier))
+				throw std::runtime_error("failed to add system " + name + ", it conflicts with " + systems[earlier].name + " but doesn't depend on it!");
+		}
+		systems.push_back(std::move(system));
+	}
+
+	bool VeSystemScheduler::dependsOn(const System& system, size_t earlier) const
+	{
+		// dependencies only point at earlier systems, so the walk ends
+		for (size_t dependency : system.dependencies)
+		{
+			if (dependency == earlier || dependsOn(systems[dependency], earlier))
+				return true;
+		}
+		return false;
+	}
+
+	void VeSystemScheduler::buildGraph()
+	{
+		graph = std::vector<SystemNode>(systems.size());
+		for (size_t later = 0; later < systems.size(); later++)
+		{
+			// addSystem made sure every conflict is covered by the declared dependencies
+			for (size_t earlier : systems[later].dependencies)
+			{
+				graph[earlier].successors.push_back(later);
+				graph[later].dependencyCount++;
+			}
+			graph[later].remainingDependencies = graph[later].dependencyCount;
+		}
+	}
+
+	void VeSystemScheduler::run(FrameInfo& frameInfo)
+	{
+		buildGraph();
+
+		JobCounter frameCounter;
+		for (size_t i = 0; i < systems.size(); i++)
+		{
+			if (graph[i].dependencyCount == 0)
+				launch(i, frameInfo, frameCounter);
+		}
+		veJobSystem.wait(frameCounter);
+
+		commandBuffer.playback(frameInfo.entityManager);
+	}
+
+	void VeSystemScheduler::launch(size_t systemIndex, FrameInfo& frameInfo, JobCounter& frameCounter)
+	{
+		veJobSystem.schedule([this, systemIndex, &frameInfo, &frameCounter]()
+		{
+			systems[systemIndex].function(frameInfo);
+
+			// successors are scheduled before this job finishes, so the frame counter can't reach zero early
+			for (size_t successor : graph[systemIndex].successors)
+			{
+				if (graph[successor].remainingDependencies.fetch_sub(1) == 1)
+					launch(successor, frameInfo, frameCounter);
+			}
+		}, &frameCounter);
+	}
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "ve_ecs.h"
+#include "ve_entity_command_buffer.h"
+#include "ve_frame_info.h"
+#include "ve_job_system.h"
+
+// std
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ve
+{
+	// components a system reads and writes, and whose change bits it takes
+	struct SystemAccess
+	{
+		template<typename... ComponentTypes>
+		SystemAccess& read()
+		{
+			reads |= getComponentMask<ComponentTypes...>();
+			return *this;
+		}
+
+		template<typename... ComponentTypes>
+		SystemAccess& write()
+		{
+			writes |= getComponentMask<ComponentTypes...>();
+			return *this;
+		}
+
+		// takeChanges clears the pool's change bits, which the writers set, so consuming them
+		// conflicts with writers and other consumers but not with readers
+		template<typename... ComponentTypes>
+		SystemAccess& consume()
+		{
+			consumes |= getComponentMask<ComponentTypes...>();
+			return *this;
+		}
+
+		// true if the two systems can't run at the same time
+		bool conflictsWith(const SystemAccess& other) const
+		{
+			return (writes & (other.reads | other.writes | other.consumes))
+				|| (reads & other.writes)
+				|| (consumes & (other.writes | other.consumes));
+		}
+
+		ComponentMask reads = 0;
+		ComponentMask writes = 0;
+		ComponentMask consumes = 0;
+	};
+
+	// runs systems on the job system. a system waits for the systems it names as dependencies,
+	// systems that don't depend on each other run concurrently. the declared component access
+	// only validates the dependencies: a system whose access conflicts with an earlier one has
+	// to depend on it, directly or through other dependencies, or adding it throws. an order
+	// that only came from registration would break silently when systems are moved around.
+	// systems can't change the structure of the world while others iterate it, they record
+	// structural changes into the scheduler's command buffer which is played back after all of them.
+	class VeSystemScheduler
+	{
+	public:
+		using SystemFunction = std::function<void(FrameInfo&)>;
+
+		VeSystemScheduler(VeJobSystem& jobSystem) : veJobSystem(jobSystem), commandBuffer(jobSystem.getNumThreads()) {}
+
+		VeSystemScheduler(const VeSystemScheduler&) = delete;
+		VeSystemScheduler& operator=(const VeSystemScheduler&) = delete;
+
+		// after names systems registered before this one that have to finish before it starts,
+		// throws when a name is unknown or a conflicting earlier system isn't covered by them
+		void addSystem(const std::string& name, const SystemAccess& access, SystemFunction function,
+			const std::vector<std::string>& after = {});
+
+		// runs every system once, returns when all of them finished and their commands were applied
+		void run(FrameInfo& frameInfo);
+
+		EntityCommandBuffer& getCommandBuffer() { return commandBuffer; }
+
+	private:
+		struct System
+		{
+			std::string name;
+			SystemAccess access;
+			SystemFunction function;
+			// indices of the systems named in after
+			std::vector<size_t> dependencies;
+		};
+
+		struct SystemNode
+		{
+			std::vector<size_t> successors;
+			int32_t dependencyCount = 0;
+			std::atomic<int32_t> remainingDependencies{ 0 };
+		};
+
+		// true if system waits for earlier through its declared dependencies, directly or not
+		bool dependsOn(const System& system, size_t earlier) const;
+		void buildGraph();
+		void launch(size_t systemIndex, FrameInfo& frameInfo, JobCounter& frameCounter);
+
+		VeJobSystem& veJobSystem;
+		EntityCommandBuffer commandBuffer;
+		std::vector<System> systems;
+		std::vector<SystemNode> graph;
+	};
+}
@@ -1,11 +1,13 @@
 #include "ve_texture.h"
 
 #include "ve_buffer.h"
+#include "ve_texture_table.h"
 
 // libs
 #include <stb_image.h>
 
 // std
+#include <cassert>
 #include <cmath>
 #include <stdexcept>
 
@@ -13,10 +15,14 @@ namespace ve
 {
 
 	VeTexture::VeTexture(VeDevice& device, const std::string& textureFilepath) : mDevice{ device } {
+		VeTextureTable* table = device.getTextureTable();
+		if (!table)
+			throw std::runtime_error("failed to create texture, the device has no texture table!");
 		createTextureImage(textureFilepath);
 		createTextureImageView(VK_IMAGE_VIEW_TYPE_2D);
 		createTextureSampler();
 		updateDescriptor();
+		mTextureIndex = table->add(mDescriptor);
 	}
 
 	VeTexture::VeTexture(
@@ -105,6 +111,11 @@ namespace ve
 	}
 
 	VeTexture::~VeTexture() {
+		if (mTextureIndex != VeTextureTable::INVALID_INDEX)
+		{
+			assert(mDevice.getTextureTable() && "Textures must be destroyed before the texture table.");
+			mDevice.getTextureTable()->remove(mTextureIndex);
+		}
 		vkDestroySampler(mDevice.device(), mTextureSampler, nullptr);
 		vkDestroyImageView(mDevice.device(), mTextureImageView, nullptr);
 		vkDestroyImage(mDevice.device(), mTextureImage, nullptr);
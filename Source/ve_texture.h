@@ -32,6 +32,9 @@ namespace ve
 		VkImageLayout getImageLayout() const { return mTextureLayout; }
 		VkExtent3D getExtent() const { return mExtent; }
 		VkFormat getFormat() const { return mFormat; }
+		// index in the device's texture table, textures loaded from a file are added to it on creation
+		// and need the table to exist. attachments aren't in it and return VeTextureTable::INVALID_INDEX
+		uint32_t getTextureIndex() const { return mTextureIndex; }
 
 		void updateDescriptor();
 		void transitionLayout(
@@ -57,6 +60,7 @@ namespace ve
 		uint32_t mMipLevels{ 1 };
 		uint32_t mLayerCount{ 1 };
 		VkExtent3D mExtent{};
+		uint32_t mTextureIndex = ~0u;
 	};
 
 }  // namespace lve
@@ -0,0 +1,72 @@
+#include "ve_texture_table.h"
+
+#include "ve_texture.h"
+
+// std
+#include <cassert>
+#include <stdexcept>
+
+namespace ve
+{
+	VeTextureTable::VeTextureTable(VeDevice& device) : veDevice(device)
+	{
+		assert(!device.getTextureTable() && "The device already has a texture table.");
+
+		// unused elements are never written, descriptors are written while earlier frames using
+		// other elements are still in flight
+		setLayout = VeDescriptorSetLayout::Builder(veDevice)
+			.addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, MAX_TEXTURES)
+			.setBindingFlags(0, VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT
+				| VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+				| VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT)
+			.build();
+		pool = VeDescriptorPool::Builder(veDevice)
+			.setMaxSets(1)
+			.setPoolFlags(VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT)
+			.addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_TEXTURES)
+			.build();
+		if (!pool->allocateDescriptor(setLayout->getDescriptorSetLayout(), set))
+			throw std::runtime_error("failed to allocate texture table descriptor set!");
+
+		device.setTextureTable(this);
+		// the first texture added gets index 0
+		defaultTexture = std::make_shared<VeTexture>(device, DEFAULT_TEXTURE_PATH);
+		assert(defaultTexture->getTextureIndex() == DEFAULT_INDEX && "Default texture is not at the default index.");
+	}
+
+	VeTextureTable::~VeTextureTable()
+	{
+		assert(defaultTexture.use_count() == 1 && "Textures must be destroyed before the texture table.");
+		defaultTexture.reset();
+		veDevice.setTextureTable(nullptr);
+	}
+
+	uint32_t VeTextureTable::add(const VkDescriptorImageInfo& imageInfo)
+	{
+		uint32_t index;
+		if (!freeIndices.empty())
+		{
+			index = freeIndices.back();
+			freeIndices.pop_back();
+		}
+		else
+		{
+			if (nextIndex == MAX_TEXTURES)
+				throw std::runtime_error("failed to add texture, the texture table is full!");
+			index = nextIndex++;
+		}
+
+		VkDescriptorImageInfo info = imageInfo;
+		VeDescriptorWriter(*setLayout, *pool)
+			.writeImage(0, index, &info)
+			.overwrite(set);
+		return index;
+	}
+
+	void VeTextureTable::remove(uint32_t index)
+	{
+		assert(index < nextIndex && "Texture index is not valid.");
+		// the stale descriptor stays until the index is reused, partially bound arrays allow that
+		freeIndices.push_back(index);
+	}
+}
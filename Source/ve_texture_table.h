@@ -0,0 +1,50 @@
+#pragma once
+
+#include "ve_descriptors.h"
+
+// std
+#include <memory>
+#include <vector>
+
+namespace ve
+{
+	class VeTexture;
+
+	// one partially bound, update after bind array of every sampled texture. textures register
+	// themselves on creation and keep their index for their whole lifetime, so shaders select a
+	// texture by index and the set is bound once per frame. index 0 always holds the default texture
+	class VeTextureTable
+	{
+	public:
+		static constexpr uint32_t MAX_TEXTURES = 4096;
+		static constexpr uint32_t INVALID_INDEX = ~0u;
+		// sampled in place of textures that are missing or not in the table
+		static constexpr uint32_t DEFAULT_INDEX = 0;
+		static constexpr const char* DEFAULT_TEXTURE_PATH = "content/textures/missing.png";
+
+		// there is one table per device, it's set on the device for textures to find it
+		VeTextureTable(VeDevice& device);
+		~VeTextureTable();
+
+		VeTextureTable(const VeTextureTable&) = delete;
+		VeTextureTable& operator=(const VeTextureTable&) = delete;
+
+		// freed indices are reused, a texture must not be destroyed while a frame in flight samples it
+		uint32_t add(const VkDescriptorImageInfo& imageInfo);
+		void remove(uint32_t index);
+
+		VkDescriptorSetLayout getSetLayout() const { return setLayout->getDescriptorSetLayout(); }
+		VkDescriptorSet getSet() const { return set; }
+		const std::shared_ptr<VeTexture>& getDefaultTexture() const { return defaultTexture; }
+
+	private:
+		VeDevice& veDevice;
+		std::unique_ptr<VeDescriptorSetLayout> setLayout;
+		std::unique_ptr<VeDescriptorPool> pool;
+		VkDescriptorSet set = VK_NULL_HANDLE;
+		std::shared_ptr<VeTexture> defaultTexture;
+
+		std::vector<uint32_t> freeIndices;
+		uint32_t nextIndex = 0;
+	};
+}
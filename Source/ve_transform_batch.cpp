@@ -0,0 +1,290 @@
+#include "ve_transform_batch.h"
+
+// std
+#include <cmath>
+
+#if defined(__AVX2__)
+#define VE_TRANSFORM_AVX2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VE_TRANSFORM_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace ve
+{
+	namespace
+	{
+		// one transform at a time, also handles the tail of the vectorized loops
+		struct ScalarLane
+		{
+			static constexpr int32_t WIDTH = 1;
+			float v;
+
+			ScalarLane(float value) : v(value) {}
+			static ScalarLane load(const float* source) { return *source; }
+			void store(float* destination) const { *destination = v; }
+
+			friend ScalarLane operator+(ScalarLane a, ScalarLane b) { return a.v + b.v; }
+			friend ScalarLane operator-(ScalarLane a, ScalarLane b) { return a.v - b.v; }
+			friend ScalarLane operator*(ScalarLane a, ScalarLane b) { return a.v * b.v; }
+			friend ScalarLane operator/(ScalarLane a, ScalarLane b) { return a.v / b.v; }
+			friend ScalarLane operator-(ScalarLane a) { return -a.v; }
+
+			friend void sincos(ScalarLane x, ScalarLane& outSin, ScalarLane& outCos)
+			{
+				outSin = std::sin(x.v);
+				outCos = std::cos(x.v);
+			}
+		};
+
+		// cephes single precision sincos: reduce to [-pi/4, pi/4] around the nearest multiple of pi/2,
+		// evaluate both polynomials and pick/negate them by quadrant
+		constexpr float PI_OVER_2_1 = 1.5703125f;
+		constexpr float PI_OVER_2_2 = 4.837512969970703125e-4f;
+		constexpr float PI_OVER_2_3 = 7.54978995489188216e-8f;
+		constexpr float TWO_OVER_PI = 0.636619772367581343f;
+		constexpr float SIN_C0 = -1.9515295891e-4f;
+		constexpr float SIN_C1 = 8.3321608736e-3f;
+		constexpr float SIN_C2 = -1.6666654611e-1f;
+		constexpr float COS_C0 = 2.443315711809948e-5f;
+		constexpr float COS_C1 = -1.388731625493765e-3f;
+		constexpr float COS_C2 = 4.166664568298827e-2f;
+
+#if VE_TRANSFORM_SSE2
+		struct SseLane
+		{
+			static constexpr int32_t WIDTH = 4;
+			__m128 v;
+
+			SseLane(__m128 value) : v(value) {}
+			SseLane(float value) : v(_mm_set1_ps(value)) {}
+			static SseLane load(const float* source) { return _mm_loadu_ps(source); }
+			void store(float* destination) const { _mm_storeu_ps(destination, v); }
+
+			friend SseLane operator+(SseLane a, SseLane b) { return _mm_add_ps(a.v, b.v); }
+			friend SseLane operator-(SseLane a, SseLane b) { return _mm_sub_ps(a.v, b.v); }
+			friend SseLane operator*(SseLane a, SseLane b) { return _mm_mul_ps(a.v, b.v); }
+			friend SseLane operator/(SseLane a, SseLane b) { return _mm_div_ps(a.v, b.v); }
+			friend SseLane operator-(SseLane a) { return _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)); }
+
+			friend void sincos(SseLane x, SseLane& outSin, SseLane& outCos)
+			{
+				const __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(x.v, _mm_set1_ps(TWO_OVER_PI)));
+				const __m128 j = _mm_cvtepi32_ps(quadrant);
+				__m128 y = _mm_sub_ps(x.v, _mm_mul_ps(j, _mm_set1_ps(PI_OVER_2_1)));
+				y = _mm_sub_ps(y, _mm_mul_ps(j, _mm_set1_ps(PI_OVER_2_2)));
+				y = _mm_sub_ps(y, _mm_mul_ps(j, _mm_set1_ps(PI_OVER_2_3)));
+				const __m128 z = _mm_mul_ps(y, y);
+
+				__m128 sinPoly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(SIN_C0), z), _mm_set1_ps(SIN_C1));
+				sinPoly = _mm_add_ps(_mm_mul_ps(sinPoly, z), _mm_set1_ps(SIN_C2));
+				sinPoly = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sinPoly, z), y), y);
+
+				__m128 cosPoly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(COS_C0), z), _mm_set1_ps(COS_C1));
+				cosPoly = _mm_add_ps(_mm_mul_ps(cosPoly, z), _mm_set1_ps(COS_C2));
+				cosPoly = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(cosPoly, z), z), _mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(z, _mm_set1_ps(0.5f))));
+
+				// odd quadrants swap sine and cosine, bit 1 of the quadrant negates sine and of quadrant + 1 negates cosine
+				const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+				const __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(2)), 30));
+				const __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+				const __m128 sinValue = _mm_or_ps(_mm_and_ps(swap, cosPoly), _mm_andnot_ps(swap, sinPoly));
+				const __m128 cosValue = _mm_or_ps(_mm_and_ps(swap, sinPoly), _mm_andnot_ps(swap, cosPoly));
+				outSin = _mm_xor_ps(sinValue, sinSign);
+				outCos = _mm_xor_ps(cosValue, cosSign);
+			}
+		};
+		using VectorLane = SseLane;
+#elif VE_TRANSFORM_AVX2
+		struct AvxLane
+		{
+			static constexpr int32_t WIDTH = 8;
+			__m256 v;
+
+			AvxLane(__m256 value) : v(value) {}
+			AvxLane(float value) : v(_mm256_set1_ps(value)) {}
+			static AvxLane load(const float* source) { return _mm256_loadu_ps(source); }
+			void store(float* destination) const { _mm256_storeu_ps(destination, v); }
+
+			friend AvxLane operator+(AvxLane a, AvxLane b) { return _mm256_add_ps(a.v, b.v); }
+			friend AvxLane operator-(AvxLane a, AvxLane b) { return _mm256_sub_ps(a.v, b.v); }
+			friend AvxLane operator*(AvxLane a, AvxLane b) { return _mm256_mul_ps(a.v, b.v); }
+			friend AvxLane operator/(AvxLane a, AvxLane b) { return _mm256_div_ps(a.v, b.v); }
+			friend AvxLane operator-(AvxLane a) { return _mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)); }
+
+			friend void sincos(AvxLane x, AvxLane& outSin, AvxLane& outCos)
+			{
+				const __m256i quadrant = _mm256_cvtps_epi32(_mm256_mul_ps(x.v, _mm256_set1_ps(TWO_OVER_PI)));
+				const __m256 j = _mm256_cvtepi32_ps(quadrant);
+				__m256 y = _mm256_sub_ps(x.v, _mm256_mul_ps(j, _mm256_set1_ps(PI_OVER_2_1)));
+				y = _mm256_sub_ps(y, _mm256_mul_ps(j, _mm256_set1_ps(PI_OVER_2_2)));
+				y = _mm256_sub_ps(y, _mm256_mul_ps(j, _mm256_set1_ps(PI_OVER_2_3)));
+				const __m256 z = _mm256_mul_ps(y, y);
+
+				__m256 sinPoly = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(SIN_C0), z), _mm256_set1_ps(SIN_C1));
+				sinPoly = _mm256_add_ps(_mm256_mul_ps(sinPoly, z), _mm256_set1_ps(SIN_C2));
+				sinPoly = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(sinPoly, z), y), y);
+
+				__m256 cosPoly = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(COS_C0), z), _mm256_set1_ps(COS_C1));
+				cosPoly = _mm256_add_ps(_mm256_mul_ps(cosPoly, z), _mm256_set1_ps(COS_C2));
+				cosPoly = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(cosPoly, z), z), _mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(z, _mm256_set1_ps(0.5f))));
+
+				const __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(1)));
+				const __m256 sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(2)), 30));
+				const __m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(2)), 30));
+				outSin = _mm256_xor_ps(_mm256_blendv_ps(sinPoly, cosPoly, swap), sinSign);
+				outCos = _mm256_xor_ps(_mm256_blendv_ps(cosPoly, sinPoly, swap), cosSign);
+			}
+		};
+		using VectorLane = AvxLane;
+#endif
+
+		// the rotation part of Ry * Rx * Rz from euler angles, r[column * 3 + row]
+		template<typename Lane>
+		struct EulerRotation
+		{
+			const TransformBatch& batch;
+
+			void operator()(int32_t index, Lane* r) const
+			{
+				Lane s1{ 0.0f }, c1{ 0.0f }, s2{ 0.0f }, c2{ 0.0f }, s3{ 0.0f }, c3{ 0.0f };
+				sincos(Lane::load(batch.rotation[1] + index), s1, c1);
+				sincos(Lane::load(batch.rotation[0] + index), s2, c2);
+				sincos(Lane::load(batch.rotation[2] + index), s3, c3);
+				r[0] = c1 * c3 + s1 * s2 * s3;
+				r[1] = c2 * s3;
+				r[2] = c1 * s2 * s3 - c3 * s1;
+				r[3] = c3 * s1 * s2 - c1 * s3;
+				r[4] = c2 * c3;
+				r[5] = c1 * c3 * s2 + s1 * s3;
+				r[6] = c2 * s1;
+				r[7] = -s2;
+				r[8] = c1 * c2;
+			}
+		};
+
+		// the rotation matrix of a unit quaternion, only multiply-adds
+		template<typename Lane>
+		struct QuaternionRotation
+		{
+			const QuaternionTransformBatch& batch;
+
+			void operator()(int32_t index, Lane* r) const
+			{
+				const Lane x = Lane::load(batch.orientation[0] + index);
+				const Lane y = Lane::load(batch.orientation[1] + index);
+				const Lane z = Lane::load(batch.orientation[2] + index);
+				const Lane w = Lane::load(batch.orientation[3] + index);
+				const Lane two{ 2.0f };
+				const Lane one{ 1.0f };
+				const Lane x2 = x * two;
+				const Lane y2 = y * two;
+				const Lane z2 = z * two;
+				const Lane xx = x * x2;
+				const Lane yy = y * y2;
+				const Lane zz = z * z2;
+				const Lane xy = x * y2;
+				const Lane xz = x * z2;
+				const Lane yz = y * z2;
+				const Lane wx = w * x2;
+				const Lane wy = w * y2;
+				const Lane wz = w * z2;
+				r[0] = one - (yy + zz);
+				r[1] = xy + wz;
+				r[2] = xz - wy;
+				r[3] = xy - wz;
+				r[4] = one - (xx + zz);
+				r[5] = yz + wx;
+				r[6] = xz + wy;
+				r[7] = yz - wx;
+				r[8] = one - (xx + yy);
+			}
+		};
+
+		// computes transforms [first, last) in groups of Lane::WIDTH, returns the first one left over
+		template<typename Lane, typename Rotation>
+		int32_t computeLanes(const float* const* translation, const float* const* scale, const Rotation& rotationOf,
+			int32_t first, int32_t last, TransformMatrices* outMatrices)
+		{
+			constexpr int32_t WIDTH = Lane::WIDTH;
+			int32_t index = first;
+			for (; index + WIDTH <= last; index += WIDTH)
+			{
+				// shared by the model and the normal matrix
+				Lane r[9] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+				rotationOf(index, r);
+
+				const Lane one{ 1.0f };
+				const Lane s[3] = { Lane::load(scale[0] + index), Lane::load(scale[1] + index), Lane::load(scale[2] + index) };
+				const Lane inverseScale[3] = { one / s[0], one / s[1], one / s[2] };
+
+				// matrix element major so every lane of an element is stored at once, then transposed to the output
+				float elements[21][WIDTH];
+				for (int32_t element = 0; element < 9; element++)
+				{
+					(s[element / 3] * r[element]).store(elements[element]);
+					(inverseScale[element / 3] * r[element]).store(elements[12 + element]);
+				}
+				Lane::load(translation[0] + index).store(elements[9]);
+				Lane::load(translation[1] + index).store(elements[10]);
+				Lane::load(translation[2] + index).store(elements[11]);
+
+				for (int32_t lane = 0; lane < WIDTH; lane++)
+				{
+					TransformMatrices& out = outMatrices[index + lane];
+					out.model[0] = elements[0][lane];
+					out.model[1] = elements[1][lane];
+					out.model[2] = elements[2][lane];
+					out.model[3] = 0.0f;
+					out.model[4] = elements[3][lane];
+					out.model[5] = elements[4][lane];
+					out.model[6] = elements[5][lane];
+					out.model[7] = 0.0f;
+					out.model[8] = elements[6][lane];
+					out.model[9] = elements[7][lane];
+					out.model[10] = elements[8][lane];
+					out.model[11] = 0.0f;
+					out.model[12] = elements[9][lane];
+					out.model[13] = elements[10][lane];
+					out.model[14] = elements[11][lane];
+					out.model[15] = 1.0f;
+					for (int32_t element = 0; element < 9; element++)
+						out.normal[element] = elements[12 + element][lane];
+				}
+			}
+			return index;
+		}
+
+		template<template<typename> typename Rotation, typename Batch>
+		void computeBatch(const Batch& batch, int32_t count, TransformMatrices* outMatrices, bool vectorized)
+		{
+			int32_t first = 0;
+#if VE_TRANSFORM_SSE2 || VE_TRANSFORM_AVX2
+			if (vectorized)
+				first = computeLanes<VectorLane>(batch.translation, batch.scale, Rotation<VectorLane>{ batch }, 0, count, outMatrices);
+#endif
+			computeLanes<ScalarLane>(batch.translation, batch.scale, Rotation<ScalarLane>{ batch }, first, count, outMatrices);
+		}
+	}
+
+	void computeTransformMatrices(const TransformBatch& batch, int32_t count, TransformMatrices* outMatrices)
+	{
+		computeBatch<EulerRotation>(batch, count, outMatrices, true);
+	}
+
+	void computeTransformMatricesScalar(const TransformBatch& batch, int32_t count, TransformMatrices* outMatrices)
+	{
+		computeBatch<EulerRotation>(batch, count, outMatrices, false);
+	}
+
+	void computeTransformMatrices(const QuaternionTransformBatch& batch, int32_t count, TransformMatrices* outMatrices)
+	{
+		computeBatch<QuaternionRotation>(batch, count, outMatrices, true);
+	}
+
+	void computeTransformMatricesScalar(const QuaternionTransformBatch& batch, int32_t count, TransformMatrices* outMatrices)
+	{
+		computeBatch<QuaternionRotation>(batch, count, outMatrices, false);
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+// std
+#include <cstdint>
+
+namespace ve
+{
+	// structure of arrays view of a batch of transforms, same convention as TransformComponent:
+	// translate * Ry * Rx * Rz * scale with angles in radians
+	struct TransformBatch
+	{
+		const float* translation[3];
+		const float* rotation[3];
+		const float* scale[3];
+	};
+
+	// same as TransformBatch with the rotation given as a unit quaternion x, y, z, w
+	struct QuaternionTransformBatch
+	{
+		const float* translation[3];
+		const float* orientation[4];
+		const float* scale[3];
+	};
+
+	// column major, laid out like a glm::mat4 followed by a glm::mat3
+	struct TransformMatrices
+	{
+		float model[16];
+		float normal[9];
+	};
+
+	// computes the model and normal matrix of count transforms in one pass. the six sines and cosines
+	// of each transform are computed once and shared by both matrices, and with SSE2/AVX2 available
+	// 4/8 transforms are processed per iteration with a vectorized sincos.
+	// the vectorized sincos is accurate to a few ulp for angles up to a few thousand radians
+	void computeTransformMatrices(const TransformBatch& batch, int32_t count, TransformMatrices* outMatrices);
+
+	// same result computed one transform at a time with std::sin/std::cos
+	void computeTransformMatricesScalar(const TransformBatch& batch, int32_t count, TransformMatrices* outMatrices);
+
+	// quaternion rotations need no trigonometry, the matrices are built from multiply-adds only
+	void computeTransformMatrices(const QuaternionTransformBatch& batch, int32_t count, TransformMatrices* outMatrices);
+	void computeTransformMatricesScalar(const QuaternionTransformBatch& batch, int32_t count, TransformMatrices* outMatrices);
+}
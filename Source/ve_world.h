@@ -0,0 +1,240 @@
+#pragma once
+
+#include "ve_ecs.h"
+
+// std
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include <cassert>
+
+namespace ve
+{
+	namespace internal
+	{
+		template<typename T, typename... Ts>
+		struct TypeIndex;
+
+		template<typename T, typename... Rest>
+		struct TypeIndex<T, T, Rest...> : std::integral_constant<size_t, 0> {};
+
+		template<typename T, typename First, typename... Rest>
+		struct TypeIndex<T, First, Rest...> : std::integral_constant<size_t, 1 + TypeIndex<T, Rest...>::value> {};
+
+		template<typename T>
+		struct TypeIndex<T>
+		{
+			static_assert(sizeof(T) == 0, "Component type is not part of this world.");
+		};
+	}
+
+	// entity manager whose component set is fixed at compile time.
+	// pools live inline in a tuple and component ids are constexpr indices into it,
+	// so getPool is a plain member access instead of a static id lookup plus a shared_ptr deref
+	template<typename... ComponentTypes>
+	class World
+	{
+	public:
+		static constexpr size_t NUM_COMPONENTS = sizeof...(ComponentTypes);
+		static_assert(NUM_COMPONENTS <= 64, "Component masks are 64 bit wide.");
+
+		World(int32_t inExpectedNumOfEntities = 100)
+			: availableEntity(-1)
+		{
+			reserveEntities(inExpectedNumOfEntities);
+		}
+		World(const World&) = delete;
+		World& operator=(const World&) = delete;
+
+		void reserveEntities(int32_t inExpectedNumOfEntities)
+		{
+			entities.reserve(inExpectedNumOfEntities);
+			signatures.reserve(inExpectedNumOfEntities);
+		}
+
+		entity_t createEntity()
+		{
+			if (availableEntity != -1)
+			{
+				const entity_t Curr = availableEntity;
+				availableEntity = entities[Curr];
+				return entities[Curr] = Curr;
+			}
+			else
+			{
+				const entity_t newEntity = entities.size();
+				entities.push_back(newEntity);
+				signatures.push_back(0);
+				std::apply([](auto&... pool) { (pool.addEntitySlot(), ...); }, pools);
+				return newEntity;
+			}
+		}
+
+		void destroyEntity(entity_t entity)
+		{
+			assert(isValid(entity) && "Entity id is not valid.");
+			std::apply([entity](auto&... pool) { (pool.removeIfExist(entity), ...); }, pools);
+			signatures[entity] = 0;
+			entities[entity] = availableEntity;
+			availableEntity = entity;
+		}
+
+		void reset()
+		{
+			availableEntity = -1;
+			size_t cap = entities.capacity();
+			entities.clear();
+			entities.reserve(cap);
+			signatures.clear();
+			std::apply([](auto&... pool) { (pool.resetPool(), ...); }, pools);
+		}
+
+		template<typename ComponentType>
+		ComponentType& AddComponent(entity_t entity)
+		{
+			signatures[entity] |= getComponentMask<ComponentType>();
+			return getPool<ComponentType>().add(entity);
+		}
+
+		template<typename ComponentType>
+		void RemoveComponent(entity_t entity)
+		{
+			getPool<ComponentType>().remove(entity);
+			signatures[entity] &= ~getComponentMask<ComponentType>();
+		}
+
+		template<typename ComponentType>
+		bool HasComponent(entity_t entity) const
+		{
+			return (signatures[entity] & getComponentMask<ComponentType>()) != 0;
+		}
+
+		template<typename... HasTypes>
+		bool HasComponents(entity_t entity) const
+		{
+			return matches(entity, getComponentMask<HasTypes...>());
+		}
+
+		bool matches(entity_t entity, ComponentMask mask) const
+		{
+			return (signatures[entity] & mask) == mask;
+		}
+
+		ComponentMask getSignature(entity_t entity) const
+		{
+			return signatures[entity];
+		}
+
+		void filterEntities(ComponentMask mask, std::vector<entity_t>& outEntities) const
+		{
+			outEntities.clear();
+			filterSignatures(signatures.data(), static_cast<int32_t>(signatures.size()), mask, outEntities);
+		}
+
+		// mutable access, marks the component as changed
+		template<typename ComponentType>
+		ComponentType& GetComponent(entity_t entity)
+		{
+			ComponentPool<ComponentType>& pool = getPool<ComponentType>();
+			pool.markChanged(entity);
+			return pool.get(entity);
+		}
+
+		template<typename ComponentType>
+		const ComponentType& ReadComponent(entity_t entity)
+		{
+			return getPool<ComponentType>().get(entity);
+		}
+
+		template<typename ComponentType>
+		void takeChanges(std::vector<uint64_t>& outBits)
+		{
+			getPool<ComponentType>().takeChanges(outBits);
+		}
+
+		template<typename ComponentType>
+		ObserverID observe(ComponentEvent event, ComponentObserver observer)
+		{
+			return getPool<ComponentType>().addObserver(event, std::move(observer));
+		}
+
+		template<typename ComponentType>
+		void removeObserver(ObserverID id)
+		{
+			getPool<ComponentType>().removeObserver(id);
+		}
+
+		void flushObservers()
+		{
+			std::apply([](auto&... pool) { ((pool.isObserved() ? pool.flushEvents() : void()), ...); }, pools);
+		}
+
+		template<typename... ViewTypes>
+		EntityView<ViewTypes...> view()
+		{
+			return EntityView<ViewTypes...>(signatures, getComponentMask<ViewTypes...>(), getPool<std::remove_const_t<ViewTypes>>()...);
+		}
+
+		bool isValid(entity_t entity) const
+		{
+			return entity < entities.size() && entities[entity] == entity;
+		}
+
+		template<typename ComponentType>
+		ComponentPool<ComponentType>& getPool()
+		{
+			return std::get<getComponentStaticID<ComponentType>()>(pools);
+		}
+
+		template<typename ComponentType>
+		const ComponentPool<ComponentType>& getPool() const
+		{
+			return std::get<getComponentStaticID<ComponentType>()>(pools);
+		}
+
+		template<typename ComponentType>
+		const std::vector<entity_t>& getEntities()
+		{
+			return getPool<ComponentType>().ownerEntities;
+		}
+
+		template<typename ComponentType>
+		static constexpr size_t getComponentStaticID()
+		{
+			return internal::TypeIndex<std::remove_const_t<ComponentType>, ComponentTypes...>::value;
+		}
+
+		template<typename... MaskTypes>
+		static constexpr ComponentMask getComponentMask()
+		{
+			return ((ComponentMask(1) << getComponentStaticID<MaskTypes>()) | ... | ComponentMask(0));
+		}
+
+		int32_t size() const
+		{
+			int32_t out = entities.size();
+			int32_t curr = availableEntity;
+			for (; curr != -1; --out)
+				curr = entities[curr];
+
+			return out;
+		}
+
+		int32_t capacity() const
+		{
+			return entities.size();
+		}
+
+	public:
+		std::vector<int32_t>::iterator begin() { return entities.begin(); }
+		std::vector<int32_t>::const_iterator begin() const { return entities.begin(); }
+		std::vector<int32_t>::iterator end() { return entities.end(); }
+		std::vector<int32_t>::const_iterator end()   const { return entities.end(); }
+	private:
+		entity_t availableEntity;
+		std::vector<entity_t> entities;
+		std::vector<ComponentMask> signatures;
+		std::tuple<ComponentPool<ComponentTypes>...> pools;
+	};
+}
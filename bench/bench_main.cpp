@@ -0,0 +1,33 @@
+#include "ve_bench.h"
+
+// std
+#include <cstring>
+
+int main(int argc, char** argv)
+{
+	// usage: VulkanEngineBench [filter] [--json results.json]
+	// the filter selects benchmarks by substring, --json also writes the results as JSON
+	const char* filter = nullptr;
+	const char* jsonPath = nullptr;
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+			jsonPath = argv[++i];
+		else
+			filter = argv[i];
+	}
+
+	for (const ve::bench::BenchmarkEntry& entry : ve::bench::registry())
+	{
+		if (filter && !std::strstr(entry.name, filter))
+			continue;
+		entry.function();
+	}
+
+	if (jsonPath && !ve::bench::writeJson(jsonPath))
+	{
+		std::fprintf(stderr, "failed to write %s\n", jsonPath);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,68 @@
+#include "ve_bench.h"
+#include "ve_ecs.h"
+#include "ve_ecs_archetype.h"
+
+namespace
+{
+	using ve::bench::BenchLight;
+	using ve::bench::BenchRenderer;
+	using ve::bench::BenchTag;
+	using ve::bench::BenchTransform;
+
+	// same workload for both backends, mesh objects with transform+tag+renderer plus a few lights
+	template<typename Manager>
+	void runWorkload(const char* label, int32_t count)
+	{
+		double createMs = ve::bench::measureMs([count]() {
+			Manager manager(count);
+			ve::bench::registerComponents<BenchTransform, BenchTag, BenchRenderer, BenchLight>(manager, count);
+			for (int32_t i = 0; i < count; i++)
+			{
+				ve::entity_t entity = manager.createEntity();
+				manager.template AddComponent<BenchTransform>(entity);
+				manager.template AddComponent<BenchTag>(entity);
+				manager.template AddComponent<BenchRenderer>(entity);
+			}
+			ve::bench::sink = manager.size();
+		}, 3);
+		ve::bench::report("ArchetypeCreate", label, count, createMs);
+
+		Manager manager(count);
+		ve::bench::registerComponents<BenchTransform, BenchTag, BenchRenderer, BenchLight>(manager, count);
+		for (int32_t i = 0; i < count; i++)
+		{
+			ve::entity_t entity = manager.createEntity();
+			manager.template AddComponent<BenchTransform>(entity).translation[0] = 1.0f;
+			manager.template AddComponent<BenchTag>(entity);
+			if (i % 64 == 0)
+				manager.template AddComponent<BenchLight>(entity);
+			else
+				manager.template AddComponent<BenchRenderer>(entity).model = 1;
+		}
+
+		double iterateMs = ve::bench::measureMs([&manager]() {
+			float sum = 0.0f;
+			for (auto [entity, transform, renderer] : manager.template view<const BenchTransform, const BenchRenderer>())
+				sum += transform.translation[0] * renderer.model;
+			ve::bench::sink = static_cast<uint64_t>(sum);
+		});
+		ve::bench::report("ArchetypeIterate", label, count, iterateMs);
+
+		double churnMs = ve::bench::measureMs([&manager, count]() {
+			for (ve::entity_t entity = 1; entity < count; entity += 64)
+				manager.template AddComponent<BenchLight>(entity);
+			for (ve::entity_t entity = 1; entity < count; entity += 64)
+				manager.template RemoveComponent<BenchLight>(entity);
+		});
+		ve::bench::report("ArchetypeAddRemove", label, count / 32, churnMs);
+	}
+}
+
+VE_BENCHMARK(ArchetypeVsSparse)
+{
+	for (int32_t count : { 1000, 100000 })
+	{
+		runWorkload<ve::EntityManager>("sparse pools", count);
+		runWorkload<ve::ArchetypeEntityManager>("archetype chunks", count);
+	}
+}
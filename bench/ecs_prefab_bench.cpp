@@ -0,0 +1,44 @@
+#include "ve_bench.h"
+#include "ve_ecs.h"
+
+// std
+#include <memory>
+
+namespace
+{
+	using ve::bench::BenchRendererRef;
+	using ve::bench::BenchTag;
+	using ve::bench::BenchTransform;
+}
+
+VE_BENCHMARK(PrefabInstantiate)
+{
+	// spawning the props of a stress level into a manager that was emptied, like a level reload.
+	// reusing the manager keeps first touch page faults of fresh memory out of the numbers
+	const int32_t count = 100000;
+	const std::shared_ptr<int> model = std::make_shared<int>(1);
+	const std::shared_ptr<int> texture = std::make_shared<int>(2);
+
+	ve::EntityManager manager;
+	ve::bench::registerComponents(manager);
+	double singleMs = ve::bench::measureMs([&]() {
+		manager.reset();
+		for (int32_t i = 0; i < count; i++)
+		{
+			const ve::entity_t entity = manager.createEntity();
+			manager.AddComponent<BenchTransform>(entity);
+			manager.AddComponent<BenchTag>(entity);
+			manager.AddComponent<BenchRendererRef>(entity) = { model, texture };
+		}
+		ve::bench::sink = manager.capacity();
+	});
+	ve::bench::report("PrefabInstantiate", "createEntity+AddComponent", count, singleMs);
+
+	ve::Prefab prefab;
+	prefab.add<BenchTransform>().add<BenchTag>().add<BenchRendererRef>({ model, texture });
+	double prefabMs = ve::bench::measureMs([&]() {
+		manager.reset();
+		ve::bench::sink = manager.instantiate(prefab, count).size();
+	});
+	ve::bench::report("PrefabInstantiate", "instantiate", count, prefabMs);
+}
@@ -0,0 +1,179 @@
+#include "ve_bench.h"
+#include "ve_components.h"
+
+// std
+#include <bit>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace
+{
+	// what updateBuffer writes per object, the storage buffer packs them tightly
+	struct BenchObjectData
+	{
+		glm::mat4 modelMatrix{ 1.f };
+		glm::mat4 normalMatrix{ 1.f };
+	};
+	constexpr size_t OBJECT_SLOT_SIZE = 128;
+	static_assert(sizeof(BenchObjectData) <= OBJECT_SLOT_SIZE, "Object data has to fit its slot.");
+
+	const int32_t SCALES[] = { 1000, 100000, 1000000 };
+
+	void registerComponents(ve::EntityManager& manager, int32_t count)
+	{
+		ve::bench::registerComponents<ve::TransformComponent, ve::WorldTransformComponent>(manager, count);
+	}
+
+	void populate(ve::EntityManager& manager, int32_t count)
+	{
+		for (int32_t i = 0; i < count; i++)
+		{
+			const ve::entity_t entity = manager.createEntity();
+			ve::TransformComponent& transform = manager.AddComponent<ve::TransformComponent>(entity);
+			transform.translation = { float(i), 0.f, 0.f };
+			transform.rotation = { 0.001f * i, 0.002f * i, 0.003f * i };
+			manager.AddComponent<ve::WorldTransformComponent>(entity);
+		}
+	}
+
+	// packs the world transforms of the entities set in changed into their slots, like VeObjectManager::updateBuffer
+	void packObjects(ve::EntityManager& manager, const std::vector<uint64_t>& changed, std::byte* mapped)
+	{
+		ve::ComponentPool<ve::WorldTransformComponent>& worlds = manager.getPool<ve::WorldTransformComponent>();
+		for (size_t word = 0; word < changed.size(); word++)
+		{
+			for (uint64_t bits = changed[word]; bits; bits &= bits - 1)
+			{
+				const ve::entity_t entity = static_cast<ve::entity_t>(word * 64) + std::countr_zero(bits);
+				const ve::WorldTransformComponent& world = worlds.get(entity);
+				BenchObjectData data{};
+				data.modelMatrix = world.matrix;
+				data.normalMatrix = glm::mat4{
+					glm::vec4(world.normalMatrix[0], 0.f),
+					glm::vec4(world.normalMatrix[1], 0.f),
+					glm::vec4(world.normalMatrix[2], 0.f),
+					glm::vec4(0.f, 0.f, 0.f, 1.f) };
+				std::memcpy(mapped + OBJECT_SLOT_SIZE * entity, &data, sizeof(BenchObjectData));
+			}
+		}
+	}
+}
+
+VE_BENCHMARK(EcsCreateDestroy)
+{
+	for (int32_t count : SCALES)
+	{
+		ve::EntityManager manager(count);
+		registerComponents(manager, count);
+		double ms = ve::bench::measureMs([&manager, count]() {
+			manager.reset();
+			for (int32_t i = 0; i < count; i++)
+				manager.createEntity();
+			for (ve::entity_t entity = 0; entity < count; entity++)
+				manager.destroyEntity(entity);
+			ve::bench::sink = manager.capacity();
+		});
+		ve::bench::report("EcsCreateDestroy", "createEntity+destroyEntity", count, ms);
+	}
+}
+
+VE_BENCHMARK(EcsAddRemove)
+{
+	for (int32_t count : SCALES)
+	{
+		ve::EntityManager manager(count);
+		registerComponents(manager, count);
+		for (int32_t i = 0; i < count; i++)
+			manager.createEntity();
+		double ms = ve::bench::measureMs([&manager, count]() {
+			for (ve::entity_t entity = 0; entity < count; entity++)
+				manager.AddComponent<ve::TransformComponent>(entity);
+			for (ve::entity_t entity = 0; entity < count; entity++)
+				manager.RemoveComponent<ve::TransformComponent>(entity);
+			ve::bench::sink = manager.getPool<ve::TransformComponent>().size();
+		});
+		ve::bench::report("EcsAddRemove", "AddComponent+RemoveComponent", count, ms);
+	}
+}
+
+VE_BENCHMARK(EcsIterate)
+{
+	for (int32_t count : SCALES)
+	{
+		ve::EntityManager manager(count);
+		registerComponents(manager, count);
+		populate(manager, count);
+		double ms = ve::bench::measureMs([&manager]() {
+			float sum = 0.f;
+			for (auto [entity, transform, world] : manager.view<const ve::TransformComponent, const ve::WorldTransformComponent>())
+				sum += transform.translation.x + world.matrix[3][0];
+			ve::bench::sink = static_cast<uint64_t>(sum);
+		});
+		ve::bench::report("EcsIterate", "view", count, ms);
+	}
+}
+
+VE_BENCHMARK(EcsRandomAccess)
+{
+	for (int32_t count : SCALES)
+	{
+		ve::EntityManager manager(count);
+		registerComponents(manager, count);
+		populate(manager, count);
+		std::vector<ve::entity_t> order(count);
+		std::iota(order.begin(), order.end(), 0);
+		std::shuffle(order.begin(), order.end(), std::mt19937(42));
+		double ms = ve::bench::measureMs([&manager, &order]() {
+			float sum = 0.f;
+			for (ve::entity_t entity : order)
+				sum += manager.GetComponent<ve::TransformComponent>(entity).translation.x;
+			ve::bench::sink = static_cast<uint64_t>(sum);
+		});
+		ve::bench::report("EcsRandomAccess", "GetComponent shuffled", count, ms);
+	}
+}
+
+VE_BENCHMARK(TransformMatrices)
+{
+	for (int32_t count : SCALES)
+	{
+		ve::EntityManager manager(count);
+		registerComponents(manager, count);
+		populate(manager, count);
+		double ms = ve::bench::measureMs([&manager]() {
+			for (auto [entity, transform, world] : manager.view<const ve::TransformComponent, ve::WorldTransformComponent>())
+			{
+				world.matrix = transform.mat4();
+				world.normalMatrix = transform.normalMatrix();
+			}
+			ve::bench::sink = manager.getPool<ve::WorldTransformComponent>().size();
+		});
+		ve::bench::report("TransformMatrices", "mat4+normalMatrix", count, ms);
+	}
+}
+
+VE_BENCHMARK(ObjectBufferPacking)
+{
+	for (int32_t count : SCALES)
+	{
+		ve::EntityManager manager(count);
+		registerComponents(manager, count);
+		populate(manager, count);
+		std::vector<std::byte> mapped(OBJECT_SLOT_SIZE * count);
+
+		// every object moved, then a frame where one in ten did
+		std::vector<uint64_t> changed((count + 63) / 64, 0);
+		for (ve::entity_t entity = 0; entity < count; entity++)
+			changed[entity >> 6] |= uint64_t(1) << (entity & 63);
+		double allMs = ve::bench::measureMs([&]() { packObjects(manager, changed, mapped.data()); });
+		ve::bench::report("ObjectBufferPacking", "all changed", count, allMs);
+
+		std::fill(changed.begin(), changed.end(), 0);
+		for (ve::entity_t entity = 0; entity < count; entity += 10)
+			changed[entity >> 6] |= uint64_t(1) << (entity & 63);
+		double someMs = ve::bench::measureMs([&]() { packObjects(manager, changed, mapped.data()); });
+		ve::bench::report("ObjectBufferPacking", "10% changed", count / 10, someMs);
+	}
+}
@@ -0,0 +1,72 @@
+#include "ve_bench.h"
+#include "ve_ecs.h"
+#include "ve_scene_snapshot.h"
+
+// std
+#include <cstdio>
+
+namespace
+{
+	using ve::bench::BenchLight;
+	using ve::bench::BenchTag;
+	using ve::bench::BenchTransform;
+
+	void registerComponents(ve::EntityManager& manager, int32_t count)
+	{
+		ve::bench::registerComponents<BenchTransform, BenchTag>(manager, count);
+	}
+
+	// builds the level one entity at a time, like FirstApp::loadEntities
+	void buildLevel(ve::EntityManager& manager, int32_t count)
+	{
+		for (int32_t i = 0; i < count; i++)
+		{
+			ve::entity_t entity = manager.createEntity();
+			manager.AddComponent<BenchTransform>(entity);
+			manager.AddComponent<BenchTag>(entity).tags = i;
+			manager.GetComponent<BenchTransform>(entity).translation[0] = static_cast<float>(i);
+			if (i % 16 == 0)
+				manager.AddComponent<BenchLight>(entity).intensity = 1.0f;
+		}
+	}
+}
+
+VE_BENCHMARK(SceneSnapshotLoad)
+{
+	const int32_t count = 200000;
+	const char* path = "ve_snapshot_bench.vesnap";
+
+	double buildMs = ve::bench::measureMs([count]() {
+		ve::EntityManager manager(count);
+		registerComponents(manager, count);
+		buildLevel(manager, count);
+		ve::bench::sink = manager.size();
+	}, 3);
+	ve::bench::report("SceneSnapshotLoad", "per entity build", count, buildMs);
+
+	{
+		ve::EntityManager manager(count);
+		registerComponents(manager, count);
+		buildLevel(manager, count);
+		ve::VeSnapshotWriter writer(manager);
+		writer.addPool<BenchTransform>(1);
+		writer.addPool<BenchTag>(2);
+		writer.addPool<BenchLight>(3);
+		double saveMs = ve::bench::measureMs([&writer, path]() { writer.save(path); }, 3);
+		ve::bench::report("SceneSnapshotLoad", "save", count, saveMs);
+	}
+
+	double loadMs = ve::bench::measureMs([count, path]() {
+		ve::EntityManager manager(count);
+		registerComponents(manager, count);
+		ve::VeSnapshotReader reader(path);
+		reader.restoreEntities(manager);
+		reader.readPool<BenchTransform>(manager, 1);
+		reader.readPool<BenchTag>(manager, 2);
+		reader.readPool<BenchLight>(manager, 3);
+		ve::bench::sink = manager.size();
+	}, 3);
+	ve::bench::report("SceneSnapshotLoad", "mmap load", count, loadMs);
+
+	std::remove(path);
+}
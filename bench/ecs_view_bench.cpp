@@ -0,0 +1,118 @@
+#include "ve_bench.h"
+#include "ve_ecs.h"
+
+namespace
+{
+	using ve::bench::BenchRenderer;
+	using ve::bench::BenchTransform;
+
+	// every entity has a transform and every other one is rendered, like meshes mixed with lights and empties
+	void populate(ve::EntityManager& manager, int32_t count)
+	{
+		ve::bench::registerComponents<BenchTransform, BenchRenderer>(manager, count);
+		for (int32_t i = 0; i < count; i++)
+		{
+			ve::entity_t entity = manager.createEntity();
+			manager.AddComponent<BenchTransform>(entity).translation[0] = 1.0f;
+			if (i % 2 == 0)
+				manager.AddComponent<BenchRenderer>(entity).model = 1;
+		}
+	}
+}
+
+VE_BENCHMARK(EntityViewIterate)
+{
+	const int32_t count = 50000;
+	ve::EntityManager manager(count);
+	populate(manager, count);
+
+	double lookupMs = ve::bench::measureMs([&manager]() {
+		float sum = 0.0f;
+		for (ve::entity_t entity : manager.getEntities<BenchRenderer>())
+		{
+			const BenchTransform& transform = manager.GetComponent<BenchTransform>(entity);
+			const BenchRenderer& renderer = manager.GetComponent<BenchRenderer>(entity);
+			sum += transform.translation[0] * renderer.model;
+		}
+		ve::bench::sink = static_cast<uint64_t>(sum);
+	});
+	// n is the population like in the other ecs benchmarks, half of it matches
+	ve::bench::report("EntityViewIterate", "getEntities+GetComponent", count, lookupMs);
+
+	double viewMs = ve::bench::measureMs([&manager]() {
+		float sum = 0.0f;
+		for (auto [entity, transform, renderer] : manager.view<const BenchTransform, const BenchRenderer>())
+			sum += transform.translation[0] * renderer.model;
+		ve::bench::sink = static_cast<uint64_t>(sum);
+	});
+	ve::bench::report("EntityViewIterate", "view", count, viewMs);
+}
+
+VE_BENCHMARK(EntitySignatureFilter)
+{
+	const int32_t count = 50000;
+	ve::EntityManager manager(count);
+	populate(manager, count);
+	const ve::ComponentMask mask = ve::getComponentMask<BenchTransform, BenchRenderer>();
+
+	double hasMs = ve::bench::measureMs([&manager]() {
+		uint64_t matched = 0;
+		for (ve::entity_t entity = 0; entity < manager.capacity(); entity++)
+			matched += manager.HasComponent<BenchTransform>(entity) && manager.HasComponent<BenchRenderer>(entity);
+		ve::bench::sink = matched;
+	});
+	ve::bench::report("EntitySignatureFilter", "HasComponent x2", count, hasMs);
+
+	std::vector<ve::entity_t> matches;
+	matches.reserve(count);
+	double filterMs = ve::bench::measureMs([&manager, &matches, mask]() {
+		manager.filterEntities(mask, matches);
+		ve::bench::sink = matches.size();
+	});
+	ve::bench::report("EntitySignatureFilter", "filterEntities", count, filterMs);
+}
+
+VE_BENCHMARK(ComponentObservers)
+{
+	// a derived per entity table (like descriptor sets or gpu slots) kept in sync with the renderers
+	// while 1% of them are replaced each frame
+	const int32_t count = 100000;
+	const int32_t churn = count / 100;
+	ve::EntityManager manager(count);
+	populate(manager, count);
+
+	std::vector<uint8_t> derived(count, 0);
+	auto replaceRenderers = [&manager, churn](int32_t frame) {
+		for (int32_t i = 0; i < churn; i++)
+		{
+			const ve::entity_t entity = (frame * churn + i) * 2 % count;
+			manager.RemoveComponent<BenchRenderer>(entity);
+			manager.AddComponent<BenchRenderer>(entity);
+		}
+	};
+
+	int32_t frame = 0;
+	double rescanMs = ve::bench::measureMs([&]() {
+		replaceRenderers(frame++);
+		std::fill(derived.begin(), derived.end(), 0);
+		for (ve::entity_t entity : manager.getEntities<BenchRenderer>())
+			derived[entity] = 1;
+		ve::bench::sink = derived[0];
+	});
+	ve::bench::report("ComponentObservers", "rescan pool", churn, rescanMs);
+
+	manager.observe<BenchRenderer>(ve::COMPONENT_REMOVED, [&derived](const ve::entity_t* entities, int32_t num) {
+		for (int32_t i = 0; i < num; i++)
+			derived[entities[i]] = 0;
+	});
+	manager.observe<BenchRenderer>(ve::COMPONENT_ADDED, [&derived](const ve::entity_t* entities, int32_t num) {
+		for (int32_t i = 0; i < num; i++)
+			derived[entities[i]] = 1;
+	});
+	double observeMs = ve::bench::measureMs([&]() {
+		replaceRenderers(frame++);
+		manager.flushObservers();
+		ve::bench::sink = derived[0];
+	});
+	ve::bench::report("ComponentObservers", "observers", churn, observeMs);
+}
@@ -0,0 +1,70 @@
+#include "ve_bench.h"
+#include "ve_ecs.h"
+#include "ve_world.h"
+
+// std
+#include <algorithm>
+#include <random>
+
+namespace
+{
+	using ve::bench::BenchLight;
+	using ve::bench::BenchRenderer;
+	using ve::bench::BenchTransform;
+
+	using BenchWorld = ve::World<BenchTransform, BenchRenderer, BenchLight>;
+
+	// random access order so the lookup cost isn't hidden behind a linear prefetch
+	std::vector<ve::entity_t> shuffledEntities(int32_t count)
+	{
+		std::vector<ve::entity_t> order(count);
+		for (int32_t i = 0; i < count; i++)
+			order[i] = i;
+		std::shuffle(order.begin(), order.end(), std::mt19937(1234));
+		return order;
+	}
+
+	template<typename Manager>
+	void populate(Manager& manager, int32_t count)
+	{
+		for (int32_t i = 0; i < count; i++)
+		{
+			ve::entity_t entity = manager.createEntity();
+			manager.template AddComponent<BenchTransform>(entity).translation[0] = 1.0f;
+			manager.template AddComponent<BenchRenderer>(entity).model = 1;
+		}
+	}
+
+	template<typename Manager>
+	double measureGetComponent(Manager& manager, const std::vector<ve::entity_t>& order)
+	{
+		return ve::bench::measureMs([&manager, &order]() {
+			float sum = 0.0f;
+			for (ve::entity_t entity : order)
+			{
+				BenchTransform& transform = manager.template GetComponent<BenchTransform>(entity);
+				const BenchRenderer& renderer = manager.template ReadComponent<BenchRenderer>(entity);
+				transform.translation[1] += 1.0f;
+				sum += transform.translation[0] * renderer.model;
+			}
+			ve::bench::sink = static_cast<uint64_t>(sum);
+		});
+	}
+}
+
+VE_BENCHMARK(WorldGetComponent)
+{
+	const int32_t count = 100000;
+	const std::vector<ve::entity_t> order = shuffledEntities(count);
+
+	ve::EntityManager manager(count);
+	ve::bench::registerComponents<BenchTransform, BenchRenderer>(manager, count);
+	populate(manager, count);
+	ve::bench::report("WorldGetComponent", "EntityManager", count, measureGetComponent(manager, order));
+
+	BenchWorld world(count);
+	world.getPool<BenchTransform>().reserve(count);
+	world.getPool<BenchRenderer>().reserve(count);
+	populate(world, count);
+	ve::bench::report("WorldGetComponent", "World", count, measureGetComponent(world, order));
+}
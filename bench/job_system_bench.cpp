@@ -0,0 +1,105 @@
+#include "ve_bench.h"
+#include "ve_ecs.h"
+#include "ve_job_system.h"
+
+// std
+#include <cmath>
+#include <string>
+
+namespace
+{
+	using ve::bench::BenchTransform;
+
+	struct BenchMatrix
+	{
+		float values[16];
+	};
+
+	// roughly the cost of TransformComponent::mat4, six trig calls and a handful of multiplies
+	void computeMatrix(const BenchTransform& transform, BenchMatrix& out)
+	{
+		const float c3 = std::cos(transform.rotation[2]);
+		const float s3 = std::sin(transform.rotation[2]);
+		const float c2 = std::cos(transform.rotation[0]);
+		const float s2 = std::sin(transform.rotation[0]);
+		const float c1 = std::cos(transform.rotation[1]);
+		const float s1 = std::sin(transform.rotation[1]);
+		out.values[0] = transform.scale[0] * (c1 * c3 + s1 * s2 * s3);
+		out.values[1] = transform.scale[0] * (c2 * s3);
+		out.values[2] = transform.scale[0] * (c1 * s2 * s3 - c3 * s1);
+		out.values[4] = transform.scale[1] * (c3 * s1 * s2 - c1 * s3);
+		out.values[5] = transform.scale[1] * (c2 * c3);
+		out.values[6] = transform.scale[1] * (c1 * c3 * s2 + s1 * s3);
+		out.values[8] = transform.scale[2] * (c2 * s1);
+		out.values[9] = transform.scale[2] * (-s2);
+		out.values[10] = transform.scale[2] * (c1 * c2);
+		out.values[12] = transform.translation[0];
+		out.values[13] = transform.translation[1];
+		out.values[14] = transform.translation[2];
+		out.values[15] = 1.0f;
+	}
+}
+
+VE_BENCHMARK(JobSystemScaling)
+{
+	const int32_t count = 1000000;
+	ve::EntityManager manager(count);
+	ve::bench::registerComponents<BenchTransform>(manager, count);
+	for (int32_t i = 0; i < count; i++)
+	{
+		BenchTransform& transform = manager.AddComponent<BenchTransform>(manager.createEntity());
+		transform.rotation[0] = i * 0.001f;
+		transform.rotation[1] = i * 0.002f;
+		transform.rotation[2] = i * 0.003f;
+	}
+	std::vector<BenchMatrix> matrices(count);
+
+	// 4 workers are always measured, on machines with fewer cores those runs are oversubscribed
+	const uint32_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	const uint32_t maxThreads = std::max(hardwareThreads, 4u);
+	for (uint32_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+	{
+		ve::VeJobSystem jobSystem(numThreads);
+		double ms = ve::bench::measureMs([&]() {
+			jobSystem.parallelForEach(manager.view<const BenchTransform>(), 1024,
+				[&matrices](ve::entity_t entity, const BenchTransform& transform) {
+					computeMatrix(transform, matrices[entity]);
+				});
+			ve::bench::sink = static_cast<uint64_t>(matrices[count - 1].values[0]);
+		});
+		std::string label = std::to_string(numThreads) + " threads";
+		if (numThreads > hardwareThreads)
+			label += " oversubscribed";
+		ve::bench::report("JobSystemScaling", label.c_str(), count, ms);
+
+		if (numThreads < maxThreads && numThreads * 2 > maxThreads)
+			numThreads = maxThreads / 2;
+	}
+}
+
+VE_BENCHMARK(JobSystemDependencies)
+{
+	// chains of small dependent jobs, measures scheduling overhead rather than throughput
+	ve::VeJobSystem jobSystem;
+	const int32_t chains = 256;
+	const int32_t chainLength = 64;
+	double ms = ve::bench::measureMs([&]() {
+		std::vector<std::unique_ptr<ve::JobCounter>> counters;
+		std::atomic<int32_t> executed{ 0 };
+		ve::JobCounter all;
+		for (int32_t chain = 0; chain < chains; chain++)
+		{
+			counters.push_back(std::make_unique<ve::JobCounter>());
+			jobSystem.schedule([&executed]() { executed++; }, counters.back().get());
+			for (int32_t link = 1; link < chainLength; link++)
+			{
+				ve::JobCounter& previous = *counters.back();
+				counters.push_back(std::make_unique<ve::JobCounter>());
+				jobSystem.scheduleAfter(previous, [&executed]() { executed++; }, link == chainLength - 1 ? &all : counters.back().get());
+			}
+		}
+		jobSystem.wait(all);
+		ve::bench::sink = executed;
+	});
+	ve::bench::report("JobSystemDependencies", "chained jobs", chains * chainLength, ms);
+}
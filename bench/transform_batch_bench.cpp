@@ -0,0 +1,153 @@
+#include "ve_bench.h"
+#include "ve_transform_batch.h"
+
+// std
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+	struct BenchTransform
+	{
+		float translation[3];
+		float scale[3];
+		float rotation[3];
+	};
+
+	// same math as TransformComponent::mat4() and normalMatrix(), each computing its own sines and cosines
+	void modelMatrix(const BenchTransform& transform, float* out)
+	{
+		const float c3 = std::cos(transform.rotation[2]);
+		const float s3 = std::sin(transform.rotation[2]);
+		const float c2 = std::cos(transform.rotation[0]);
+		const float s2 = std::sin(transform.rotation[0]);
+		const float c1 = std::cos(transform.rotation[1]);
+		const float s1 = std::sin(transform.rotation[1]);
+		const float* scale = transform.scale;
+		const float matrix[16] = {
+			scale[0] * (c1 * c3 + s1 * s2 * s3), scale[0] * (c2 * s3), scale[0] * (c1 * s2 * s3 - c3 * s1), 0.0f,
+			scale[1] * (c3 * s1 * s2 - c1 * s3), scale[1] * (c2 * c3), scale[1] * (c1 * c3 * s2 + s1 * s3), 0.0f,
+			scale[2] * (c2 * s1), scale[2] * (-s2), scale[2] * (c1 * c2), 0.0f,
+			transform.translation[0], transform.translation[1], transform.translation[2], 1.0f };
+		for (int i = 0; i < 16; i++)
+			out[i] = matrix[i];
+	}
+
+	void normalMatrix(const BenchTransform& transform, float* out)
+	{
+		const float c3 = std::cos(transform.rotation[2]);
+		const float s3 = std::sin(transform.rotation[2]);
+		const float c2 = std::cos(transform.rotation[0]);
+		const float s2 = std::sin(transform.rotation[0]);
+		const float c1 = std::cos(transform.rotation[1]);
+		const float s1 = std::sin(transform.rotation[1]);
+		const float invScale[3] = { 1.0f / transform.scale[0], 1.0f / transform.scale[1], 1.0f / transform.scale[2] };
+		const float matrix[9] = {
+			invScale[0] * (c1 * c3 + s1 * s2 * s3), invScale[0] * (c2 * s3), invScale[0] * (c1 * s2 * s3 - c3 * s1),
+			invScale[1] * (c3 * s1 * s2 - c1 * s3), invScale[1] * (c2 * c3), invScale[1] * (c1 * c3 * s2 + s1 * s3),
+			invScale[2] * (c2 * s1), invScale[2] * (-s2), invScale[2] * (c1 * c2) };
+		for (int i = 0; i < 9; i++)
+			out[i] = matrix[i];
+	}
+}
+
+VE_BENCHMARK(TransformBatchMatrices)
+{
+	const int32_t count = 100000;
+	std::mt19937 random(42);
+	std::uniform_real_distribution<float> angle(-10.0f, 10.0f);
+	std::uniform_real_distribution<float> scale(0.1f, 4.0f);
+
+	std::vector<BenchTransform> transforms(count);
+	std::vector<float> soa[9];
+	for (std::vector<float>& column : soa)
+		column.resize(count);
+	for (int32_t i = 0; i < count; i++)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			transforms[i].translation[axis] = soa[axis][i] = angle(random);
+			transforms[i].rotation[axis] = soa[3 + axis][i] = angle(random);
+			transforms[i].scale[axis] = soa[6 + axis][i] = scale(random);
+		}
+	}
+	const ve::TransformBatch batch{
+		{ soa[0].data(), soa[1].data(), soa[2].data() },
+		{ soa[3].data(), soa[4].data(), soa[5].data() },
+		{ soa[6].data(), soa[7].data(), soa[8].data() } };
+
+	std::vector<ve::TransformMatrices> reference(count);
+	double perTransformMs = ve::bench::measureMs([&transforms, &reference, count]() {
+		for (int32_t i = 0; i < count; i++)
+		{
+			modelMatrix(transforms[i], reference[i].model);
+			normalMatrix(transforms[i], reference[i].normal);
+		}
+		ve::bench::sink = static_cast<uint64_t>(reference[count - 1].model[0]);
+	});
+	ve::bench::report("TransformBatchMatrices", "mat4+normalMatrix", count, perTransformMs);
+
+	std::vector<ve::TransformMatrices> results(count);
+	double scalarMs = ve::bench::measureMs([&batch, &results, count]() {
+		ve::computeTransformMatricesScalar(batch, count, results.data());
+		ve::bench::sink = static_cast<uint64_t>(results[count - 1].model[0]);
+	});
+	ve::bench::report("TransformBatchMatrices", "batch scalar", count, scalarMs);
+
+	double batchMs = ve::bench::measureMs([&batch, &results, count]() {
+		ve::computeTransformMatrices(batch, count, results.data());
+		ve::bench::sink = static_cast<uint64_t>(results[count - 1].model[0]);
+	});
+	ve::bench::report("TransformBatchMatrices", "batch simd", count, batchMs);
+
+	// same rotations as quaternions, q = qy * qx * qz like eulerYXZToQuat
+	std::vector<float> orientation[4];
+	for (std::vector<float>& column : orientation)
+		column.resize(count);
+	for (int32_t i = 0; i < count; i++)
+	{
+		const float hx = 0.5f * soa[3][i], hy = 0.5f * soa[4][i], hz = 0.5f * soa[5][i];
+		const float qy[4] = { 0.0f, std::sin(hy), 0.0f, std::cos(hy) };
+		const float qx[4] = { std::sin(hx), 0.0f, 0.0f, std::cos(hx) };
+		const float qz[4] = { 0.0f, 0.0f, std::sin(hz), std::cos(hz) };
+		// qy * qx
+		const float a[4] = {
+			qy[3] * qx[0], qy[1] * qx[3], -qy[1] * qx[0], qy[3] * qx[3] };
+		// (qy * qx) * qz
+		orientation[0][i] = a[0] * qz[3] + a[1] * qz[2];
+		orientation[1][i] = a[1] * qz[3] - a[0] * qz[2];
+		orientation[2][i] = a[3] * qz[2] + a[2] * qz[3];
+		orientation[3][i] = a[3] * qz[3] - a[2] * qz[2];
+	}
+	const ve::QuaternionTransformBatch quaternionBatch{
+		{ soa[0].data(), soa[1].data(), soa[2].data() },
+		{ orientation[0].data(), orientation[1].data(), orientation[2].data(), orientation[3].data() },
+		{ soa[6].data(), soa[7].data(), soa[8].data() } };
+
+	std::vector<ve::TransformMatrices> quaternionResults(count);
+	double quaternionScalarMs = ve::bench::measureMs([&quaternionBatch, &quaternionResults, count]() {
+		ve::computeTransformMatricesScalar(quaternionBatch, count, quaternionResults.data());
+		ve::bench::sink = static_cast<uint64_t>(quaternionResults[count - 1].model[0]);
+	});
+	ve::bench::report("TransformBatchMatrices", "quaternion scalar", count, quaternionScalarMs);
+
+	double quaternionMs = ve::bench::measureMs([&quaternionBatch, &quaternionResults, count]() {
+		ve::computeTransformMatrices(quaternionBatch, count, quaternionResults.data());
+		ve::bench::sink = static_cast<uint64_t>(quaternionResults[count - 1].model[0]);
+	});
+	ve::bench::report("TransformBatchMatrices", "quaternion simd", count, quaternionMs);
+
+	float maxError = 0.0f;
+	float maxQuaternionError = 0.0f;
+	for (int32_t i = 0; i < count; i++)
+	{
+		for (int element = 0; element < 16; element++)
+			maxError = std::fmax(maxError, std::fabs(results[i].model[element] - reference[i].model[element]));
+		for (int element = 0; element < 9; element++)
+			maxError = std::fmax(maxError, std::fabs(results[i].normal[element] - reference[i].normal[element]));
+		for (int element = 0; element < 16; element++)
+			maxQuaternionError = std::fmax(maxQuaternionError, std::fabs(quaternionResults[i].model[element] - reference[i].model[element]));
+	}
+	std::printf("%-32s max abs error vs std::sin/cos %g, quaternion %g\n", "TransformBatchMatrices", maxError, maxQuaternionError);
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "ve_components.h"
+
+// std
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace ve::bench
+{
+	// components shared by every ecs benchmark. component type ids are process wide and handed out
+	// on first use, so all managers of a run have to register the same types in the same order.
+	// a benchmark with its own component types would shift the ids of every benchmark after it
+	struct BenchTransform
+	{
+		float translation[3];
+		float scale[3] = { 1.0f, 1.0f, 1.0f };
+		float rotation[3];
+	};
+
+	struct BenchTag
+	{
+		char name[32];
+		uint32_t tags;
+	};
+
+	struct BenchRenderer
+	{
+		uint32_t model;
+		uint32_t texture;
+	};
+
+	// holds a reference like RendererComponent, so copies aren't plain memcpys
+	struct BenchRendererRef
+	{
+		std::shared_ptr<int> model;
+		std::shared_ptr<int> texture;
+	};
+
+	struct BenchLight
+	{
+		float intensity;
+		float color[3];
+	};
+
+	template<typename ComponentType, typename... ReservedTypes>
+	constexpr bool isReserved = (std::is_same_v<ComponentType, ReservedTypes> || ...);
+
+	// registers every bench component in the one fixed order, the pools of ReservedTypes reserve count slots
+	template<typename... ReservedTypes, typename Manager>
+	void registerComponents(Manager& manager, int32_t count = 0)
+	{
+		manager.template registerComponent<BenchTransform>(isReserved<BenchTransform, ReservedTypes...> ? count : 0);
+		manager.template registerComponent<BenchTag>(isReserved<BenchTag, ReservedTypes...> ? count : 0);
+		manager.template registerComponent<BenchRenderer>(isReserved<BenchRenderer, ReservedTypes...> ? count : 0);
+		manager.template registerComponent<BenchRendererRef>(isReserved<BenchRendererRef, ReservedTypes...> ? count : 0);
+		manager.template registerComponent<BenchLight>(isReserved<BenchLight, ReservedTypes...> ? count : 0);
+		manager.template registerComponent<TransformComponent>(isReserved<TransformComponent, ReservedTypes...> ? count : 0);
+		manager.template registerComponent<WorldTransformComponent>(isReserved<WorldTransformComponent, ReservedTypes...> ? count : 0);
+	}
+
+	struct BenchmarkEntry
+	{
+		const char* name;
+		void (*function)();
+	};
+
+	inline std::vector<BenchmarkEntry>& registry()
+	{
+		static std::vector<BenchmarkEntry> entries;
+		return entries;
+	}
+
+	struct BenchmarkResult
+	{
+		const char* benchmark;
+		// labels may be built per run, so the result owns a copy
+		std::string label;
+		int64_t count;
+		double ms;
+	};
+
+	// every reported measurement of the run, in order
+	inline std::vector<BenchmarkResult>& results()
+	{
+		static std::vector<BenchmarkResult> entries;
+		return entries;
+	}
+
+	struct BenchmarkRegistrar
+	{
+		BenchmarkRegistrar(const char* name, void (*function)())
+		{
+			registry().push_back({ name, function });
+		}
+	};
+
+	// result of the measured work is written here so the optimizer can't drop it
+	inline volatile uint64_t sink = 0;
+
+	// runs function repeat times and returns the fastest run in milliseconds
+	template<typename Function>
+	double measureMs(Function&& function, int repeat = 5)
+	{
+		double best = 0.0;
+		for (int i = 0; i < repeat; i++)
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+			function();
+			auto end = std::chrono::high_resolution_clock::now();
+			double ms = std::chrono::duration<double, std::milli>(end - start).count();
+			if (i == 0 || ms < best)
+				best = ms;
+		}
+		return best;
+	}
+
+	inline void report(const char* benchmark, const char* label, int64_t count, double ms)
+	{
+		results().push_back({ benchmark, label, count, ms });
+		std::printf("%-32s %-24s n=%-9lld %10.3f ms %8.2f ns/op\n",
+			benchmark, label, static_cast<long long>(count), ms, count > 0 ? ms * 1e6 / count : 0.0);
+	}
+
+	// writes every result as one JSON document, returns false when the file can't be written
+	inline bool writeJson(const char* filepath)
+	{
+		FILE* file = std::fopen(filepath, "w");
+		if (!file)
+			return false;
+
+		// names and labels are plain identifiers, only quotes and backslashes need escaping
+		auto writeString = [file](const char* text)
+		{
+			std::fputc('"', file);
+			for (; *text; ++text)
+			{
+				if (*text == '"' || *text == '\\')
+					std::fputc('\\', file);
+				std::fputc(*text, file);
+			}
+			std::fputc('"', file);
+		};
+
+		std::fprintf(file, "{\n  \"results\": [");
+		for (size_t i = 0; i < results().size(); i++)
+		{
+			const BenchmarkResult& result = results()[i];
+			std::fprintf(file, "%s\n    { \"benchmark\": ", i == 0 ? "" : ",");
+			writeString(result.benchmark);
+			std::fprintf(file, ", \"label\": ");
+			writeString(result.label.c_str());
+			std::fprintf(file, ", \"count\": %lld, \"ms\": %.6f, \"nsPerOp\": %.3f }",
+				static_cast<long long>(result.count), result.ms, result.count > 0 ? result.ms * 1e6 / result.count : 0.0);
+		}
+		std::fprintf(file, "\n  ]\n}\n");
+		return std::fclose(file) == 0;
+	}
+}
+
+#define VE_BENCHMARK(name) \
+	static void name(); \
+	static ve::bench::BenchmarkRegistrar name##Registrar(#name, &name); \
+	static void name()
@@ -1,17 +1,14 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
 layout (location = 0) in vec3 fragColor;
 layout (location = 1) in vec3 fragPosWorld;
 layout (location = 2) in vec3 fragNormalWorld;
 layout (location = 3) in vec2 fragUv;
+layout (location = 4) flat in uint fragTextureIndex;
 
 layout (location = 0) out vec4 outColor;
 
-layout(push_constant) uniform Push{
-    mat4 modelMatrix;
-    mat3 normalMatrix;
-} push;
-
 struct PointLight {
     vec4 position; // ignore w
     vec4 color; // w is intensity
@@ -26,7 +23,8 @@ layout(set = 0, binding = 0) uniform GlobalUbo{
     int numLights;
 } ubo;
 
-layout (set = 1, binding = 1) uniform sampler2D diffuseMap;
+// texture table, instances of one draw can use different textures
+layout (set = 2, binding = 0) uniform sampler2D textures[];
 
 void main() {
     vec3 diffuseLight = ubo.ambientLightColor.xyz * ubo.ambientLightColor.w;
@@ -56,6 +54,6 @@ void main() {
     }
 
     // vec3 color = fragColor;
-    vec3 color = texture(diffuseMap, fragUv).xyz;
+    vec3 color = texture(textures[nonuniformEXT(fragTextureIndex)], fragUv).xyz;
     outColor = vec4(diffuseLight * color + specularLight * fragColor, 1.0);
 }
\ No newline at end of file
@@ -9,6 +9,7 @@ layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec3 fragPosWorld;
 layout(location = 2) out vec3 fragNormalWorld;
 layout(location = 3) out vec2 fragUv;
+layout(location = 4) flat out uint fragTextureIndex;
 
 struct PointLight {
     vec4 position; // ignore w
@@ -24,22 +25,42 @@ layout(set = 0, binding = 0) uniform GlobalUbo{
     int numLights;
 } ubo;
 
-layout(set = 1, binding = 0) uniform ObjectBufferData {
+struct ObjectData {
   mat4 modelMatrix;
   mat4 normalMatrix;
-} object;
+};
+
+layout(std430, set = 1, binding = 0) readonly buffer FrameObjects {
+  ObjectData objects[];
+} frameObjects;
+
+layout(std430, set = 1, binding = 1) readonly buffer StaticObjects {
+  ObjectData objects[];
+} staticObjects;
 
-layout(push_constant) uniform Push{
-    mat4 modelMatrix;
-    mat3 normalMatrix;
-} push;
+// object is a reference into the object buffers, the top bit selects the static buffer.
+// texture is an index into the texture table
+struct InstanceData {
+  uint object;
+  uint texture;
+};
+
+layout(std430, set = 1, binding = 2) readonly buffer Instances {
+  InstanceData instances[];
+} instances;
 
 void main()
 {
+    InstanceData instance = instances.instances[gl_InstanceIndex];
+    uint reference = instance.object;
+    uint index = reference & 0x7fffffffu;
+    ObjectData object = (reference & 0x80000000u) != 0u ? staticObjects.objects[index] : frameObjects.objects[index];
+
     vec4 positionWorld = object.modelMatrix * vec4(position, 1.0);
     gl_Position = ubo.projectionMatrix * ubo.viewMatrix * positionWorld;
     fragNormalWorld = normalize(mat3(object.normalMatrix) * normal);
     fragPosWorld = positionWorld.xyz;
     fragColor = color;
     fragUv = uv;
+    fragTextureIndex = instance.texture;
 }
\ No newline at end of file